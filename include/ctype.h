@@ -27,6 +27,28 @@
 
 #include "defs.h"
 
+/* tables are defined at global scope by libc, keep them out of test namespace */
+__BEGIN_DECLS
+
+#define _CTYPE_UPPER  0x001
+#define _CTYPE_LOWER  0x002
+#define _CTYPE_DIGIT  0x004
+#define _CTYPE_XDIGIT 0x008
+#define _CTYPE_SPACE  0x010
+#define _CTYPE_BLANK  0x020
+#define _CTYPE_PUNCT  0x040
+#define _CTYPE_CNTRL  0x080
+#define _CTYPE_GRAPH  0x100
+#define _CTYPE_PRINT  0x200
+
+/* class bits of every unsigned char value */
+extern const unsigned short __macondo_ctype_class[256];
+/* value tolower() and toupper() add to a character */
+extern const signed char __macondo_ctype_lower[256];
+extern const signed char __macondo_ctype_upper[256];
+
+__END_DECLS
+
 __MACONDO_TEST_NAMESPACE_BEGIN
 __BEGIN_DECLS
 
@@ -39,6 +61,12 @@ __BEGIN_DECLS
  * @defgroup ctype ctype routines
  * @ingroup  stdlib
  * @{
+ *
+ * Classification is a lookup in a 256 entry table of class bits and case
+ * conversion adds a difference looked up in another table, so the inline
+ * definitions below compile to a range check, one load and one AND or ADD at
+ * call sites. Values outside unsigned char range, EOF and negative char
+ * values included, belong to no class and are left as is by case conversion.
  */
 
 /**
@@ -151,6 +179,53 @@ __exctype(tolower);
  */
 __exctype(toupper);
 
+/*
+ * Definitions are used for inlining only, out of line copies live in libc
+ * for calls through pointers and builds without optimization.
+ */
+#define __CTYPE_INLINE extern __inline __attribute__((__gnu_inline__))
+
+#define __CTYPE_CLASS(name, classes)                                               \
+    __CTYPE_INLINE int name(int __c) __THROW                                       \
+    {                                                                              \
+        return (unsigned) __c < 256 ? __macondo_ctype_class[__c] & (classes) : 0; \
+    }
+
+__CTYPE_CLASS(isalnum, _CTYPE_UPPER | _CTYPE_LOWER | _CTYPE_DIGIT)
+__CTYPE_CLASS(isalpha, _CTYPE_UPPER | _CTYPE_LOWER)
+__CTYPE_CLASS(isblank, _CTYPE_BLANK)
+__CTYPE_CLASS(iscntrl, _CTYPE_CNTRL)
+__CTYPE_CLASS(isdigit, _CTYPE_DIGIT)
+__CTYPE_CLASS(isgraph, _CTYPE_GRAPH)
+__CTYPE_CLASS(islower, _CTYPE_LOWER)
+__CTYPE_CLASS(isprint, _CTYPE_PRINT)
+__CTYPE_CLASS(ispunct, _CTYPE_PUNCT)
+__CTYPE_CLASS(isspace, _CTYPE_SPACE)
+__CTYPE_CLASS(isupper, _CTYPE_UPPER)
+__CTYPE_CLASS(isxdigit, _CTYPE_XDIGIT)
+
+#undef __CTYPE_CLASS
+
+__CTYPE_INLINE int isascii(int __c) __THROW
+{
+    return (__c & ~0x7f) == 0;
+}
+
+__CTYPE_INLINE int toascii(int __c) __THROW
+{
+    return __c & 0x7f;
+}
+
+__CTYPE_INLINE int tolower(int __c) __THROW
+{
+    return (unsigned) __c < 256 ? __c + __macondo_ctype_lower[__c] : __c;
+}
+
+__CTYPE_INLINE int toupper(int __c) __THROW
+{
+    return (unsigned) __c < 256 ? __c + __macondo_ctype_upper[__c] : __c;
+}
+
 __END_DECLS
 __MACONDO_TEST_NAMESPACE_END
 
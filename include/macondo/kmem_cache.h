@@ -0,0 +1,130 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MACONDOOS_INCLUDE_MACONDO_KMEM_CACHE_H_
+#define MACONDOOS_INCLUDE_MACONDO_KMEM_CACHE_H_
+
+#include "../defs.h"
+#include <stddef.h>
+
+__BEGIN_DECLS
+
+/**
+ * @defgroup kmem_cache object caches
+ * @ingroup  kernel_library
+ * @{
+ *
+ * Object cache hands out fixed size objects carved from page sized slabs
+ * taken from mem_malloc() heap or from page frame allocator. Every object
+ * costs only one bit of slab bitmap instead of heap block header and footer.
+ * Objects are constructed once when their slab is created and are expected
+ * to be returned to cache in constructed state.
+ *
+ * Every cache has its own spin lock, so one cache may be shared between
+ * CPUs. Constructor is called with the lock held and must not use its cache.
+ */
+
+struct kmem_cache;
+
+/**
+ * @brief take slabs from page_alloc() instead of heap
+ */
+#define KMEM_CACHE_PAGES 0x01
+
+/**
+ * @brief kmem_ctor_t - object constructor, called once per object when new
+ *                      slab is added to cache
+ */
+typedef void (*kmem_ctor_t)(void *obj);
+
+/**
+ * @brief object cache statistics
+ */
+struct kmem_cache_stats {
+    size_t object_size;      /* size of object including alignment padding */
+    size_t slab_size;        /* size of one slab in bytes */
+    size_t objects_per_slab; /* objects count in one slab */
+    size_t slabs;            /* slabs count owned by cache at the moment */
+    size_t objects_in_use;   /* allocated objects */
+    size_t objects_free;     /* free objects in owned slabs */
+    size_t allocs;           /* kmem_cache_alloc() successful calls */
+    size_t frees;            /* kmem_cache_free() calls */
+    size_t slab_allocs;      /* slabs taken from heap */
+    size_t slab_frees;       /* slabs returned to heap */
+};
+
+/**
+ * @brief kmem_cache_create - creates cache of objects of the same size
+ * @param name  - name of cache, pointer must be valid while cache exists
+ * @param size  - object size in bytes
+ * @param align - object alignment, power of two or 0 for word alignment
+ * @param flags - KMEM_CACHE_* flags
+ * @param ctor  - optional object constructor, may be NULL
+ * @return        new cache or NULL if there is no memory or arguments are
+ *                invalid
+ */
+struct kmem_cache *kmem_cache_create(const char *name, size_t size, size_t align,
+                                     unsigned int flags, kmem_ctor_t ctor);
+
+/**
+ * @brief kmem_cache_destroy - releases all slabs of cache and cache itself
+ * @param cache - cache to destroy
+ *
+ * All objects must be returned to the cache before it's destroyed.
+ */
+void kmem_cache_destroy(struct kmem_cache *cache);
+
+/**
+ * @brief kmem_cache_alloc - allocates object from cache
+ * @param cache - cache to allocate from
+ * @return        constructed object or NULL if there is no memory
+ */
+void *kmem_cache_alloc(struct kmem_cache *cache);
+
+/**
+ * @brief kmem_cache_free - returns object to cache
+ * @param cache - cache object was allocated from
+ * @param obj   - object to return
+ */
+void kmem_cache_free(struct kmem_cache *cache, void *obj);
+
+/**
+ * @brief kmem_cache_shrink - returns completely free slabs to heap
+ * @param cache - cache to shrink
+ * @return        number of released slabs
+ */
+size_t kmem_cache_shrink(struct kmem_cache *cache);
+
+/**
+ * @brief kmem_cache_get_stats - fills cache statistics
+ * @param cache - cache to query
+ * @param stats - destination of statistics
+ */
+void kmem_cache_get_stats(const struct kmem_cache *cache, struct kmem_cache_stats *stats);
+
+/** @} */
+
+__END_DECLS
+
+#endif //MACONDOOS_INCLUDE_MACONDO_KMEM_CACHE_H_
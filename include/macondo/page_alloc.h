@@ -0,0 +1,110 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MACONDOOS_INCLUDE_MACONDO_PAGE_ALLOC_H_
+#define MACONDOOS_INCLUDE_MACONDO_PAGE_ALLOC_H_
+
+#include "../defs.h"
+#include <stddef.h>
+
+__BEGIN_DECLS
+
+/**
+ * @defgroup page_alloc page frame allocator
+ * @ingroup  kernel_library
+ * @{
+ *
+ * Binary buddy allocator of PAGE_SIZE frames. Block of order n is 2^n
+ * contiguous pages aligned to its own size. Freed blocks are merged with
+ * their buddies, buddy state is tracked with one bit per buddy pair.
+ */
+
+/**
+ * @brief the biggest order of block
+ */
+#define PAGE_MAX_ORDER 10
+#define PAGE_ORDER_COUNT (PAGE_MAX_ORDER + 1)
+
+/**
+ * @brief page frame allocator statistics
+ */
+struct page_alloc_stats {
+    size_t total_pages;                   /* pages managed by allocator */
+    size_t free_pages;                    /* pages not allocated at the moment */
+    size_t free_blocks[PAGE_ORDER_COUNT]; /* free blocks count per order */
+    size_t allocs;                        /* page_alloc() successful calls */
+    size_t frees;                         /* page_free() calls */
+    size_t failures;                      /* page_alloc() failed calls */
+};
+
+/**
+ * @brief page_alloc_init - makes region available for page allocation
+ * @param start           - start of region
+ * @param size            - size of region in bytes
+ * @return                  0 on success or EINVAL if region is too small
+ *
+ * Region is trimmed to whole pages and allocator bookkeeping is placed
+ * in the first pages of the region.
+ */
+int page_alloc_init(void *start, size_t size);
+
+/**
+ * @brief page_alloc - allocates 2^order contiguous pages
+ * @param order      - order of block, not bigger than PAGE_MAX_ORDER
+ * @return             address of the first page aligned to block size or NULL
+ */
+void *page_alloc(unsigned int order);
+
+/**
+ * @brief page_free - releases block allocated by page_alloc()
+ * @param addr      - address returned by page_alloc()
+ * @param order     - order block was allocated with
+ */
+void page_free(void *addr, unsigned int order);
+
+/**
+ * @brief page_order - returns the smallest order of block that fits size bytes
+ */
+unsigned int page_order(size_t size);
+
+/**
+ * @brief page_alloc_get_stats - fills page allocator statistics
+ * @param stats - destination of statistics
+ */
+void page_alloc_get_stats(struct page_alloc_stats *stats);
+
+/**
+ * @brief page_alloc_fragmentation - unusable free space index for order
+ * @param order - order of block which is going to be allocated
+ * @return        share of free pages which can't be used to allocate block of
+ *                order in thousandths: 0 means all free memory is usable, 1000
+ *                means request fails although there are free pages
+ */
+unsigned int page_alloc_fragmentation(unsigned int order);
+
+/** @} */
+
+__END_DECLS
+
+#endif //MACONDOOS_INCLUDE_MACONDO_PAGE_ALLOC_H_
@@ -0,0 +1,177 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MACONDOOS_INCLUDE_MACONDO_REGION_ALLOC_H_
+#define MACONDOOS_INCLUDE_MACONDO_REGION_ALLOC_H_
+
+#include "../defs.h"
+#include <stddef.h>
+
+__BEGIN_DECLS
+
+/**
+ * @defgroup region_alloc monotonic region allocator
+ * @ingroup  kernel_library
+ * @{
+ *
+ * Region hands out memory by bumping a pointer inside chained chunks, objects
+ * have no headers and are never freed one by one. Everything allocated from
+ * region dies at once with region_reset() or region_destroy(). It suits boot
+ * time tables and request scoped scratch data, e.g. parsed on-disk structures.
+ *
+ * First chunk may be a caller buffer so region works before heap is set up,
+ * further chunks are taken from heap and grow geometrically.
+ */
+
+struct region_chunk;
+
+/**
+ * @brief region, fields are private and may be placed on stack or embedded
+ */
+struct region {
+    char *ptr;                    /* next free byte of current chunk */
+    char *end;                    /* end of current chunk */
+    struct region_chunk *head;    /* first chunk of the chain */
+    struct region_chunk *current; /* chunk ptr points into */
+    size_t chunk_size;            /* size of the next chunk taken from heap */
+};
+
+/**
+ * @brief region_init - initializes empty region
+ * @param region     - region to initialize
+ * @param buffer     - optional first chunk, may be NULL
+ * @param size       - size of buffer
+ * @param chunk_size - size of the first chunk taken from heap, 0 for default
+ */
+void region_init(struct region *region, void *buffer, size_t size, size_t chunk_size);
+
+/**
+ * @brief region_alloc_slow - takes the next chunk and allocates from it, use
+ *                            region_alloc() instead
+ */
+void *region_alloc_slow(struct region *region, size_t size, size_t align);
+
+/**
+ * @brief region_alloc - allocates size bytes from region
+ * @param region - region to allocate from
+ * @param size   - size of allocation
+ * @param align  - power of two alignment
+ * @return         allocated memory or NULL if there is no memory
+ */
+static inline void *region_alloc(struct region *region, size_t size, size_t align)
+{
+    size_t addr = ((size_t) region->ptr + align - 1) & ~(align - 1);
+
+    if (region->ptr != NULL && addr <= (size_t) region->end
+        && size <= (size_t) region->end - addr) {
+        region->ptr = (char *) addr + size;
+        return (void *) addr;
+    }
+
+    return region_alloc_slow(region, size, align);
+}
+
+/**
+ * @brief region_reset - frees everything allocated from region in O(1),
+ *                       chunks are kept and reused by next allocations
+ * @param region - region to reset
+ */
+void region_reset(struct region *region);
+
+/**
+ * @brief region_destroy - frees everything and gives chunks back to heap,
+ *                         caller buffer is kept and region may be used again
+ * @param region - region to destroy
+ */
+void region_destroy(struct region *region);
+
+/** @} */
+
+__END_DECLS
+
+#ifdef __cplusplus
+
+namespace macondo
+{
+
+/**
+ * @ingroup  region_alloc
+ * @class macondo::region_allocator
+ * @brief allocator for containers which allocates from region, deallocate()
+ *        is no-op and memory is released with the region
+ * @tparam _Type type of allocated objects
+ */
+template<typename _Type>
+class region_allocator
+{
+public:
+    using value_type = _Type;
+
+    explicit region_allocator(struct region *__region) noexcept
+        : _M_region(__region)
+    {}
+
+    template<typename _Other>
+    region_allocator(const region_allocator<_Other> &__other) noexcept
+        : _M_region(__other.region())
+    {}
+
+    _Type *allocate(size_t __n)
+    {
+        if (__n > static_cast<size_t>(-1) / sizeof(_Type)) {
+            return nullptr;
+        }
+
+        return static_cast<_Type *>(region_alloc(_M_region, __n * sizeof(_Type), alignof(_Type)));
+    }
+
+    void deallocate(_Type *, size_t) noexcept
+    {}
+
+    struct region *region() const noexcept
+    {
+        return _M_region;
+    }
+
+    template<typename _Other>
+    bool operator==(const region_allocator<_Other> &__other) const noexcept
+    {
+        return _M_region == __other.region();
+    }
+
+    template<typename _Other>
+    bool operator!=(const region_allocator<_Other> &__other) const noexcept
+    {
+        return _M_region != __other.region();
+    }
+private:
+    struct region *_M_region;
+};
+
+} // namespace macondo
+
+#endif /* __cplusplus */
+
+#endif //MACONDOOS_INCLUDE_MACONDO_REGION_ALLOC_H_
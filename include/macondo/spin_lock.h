@@ -28,7 +28,6 @@
 // Based on "Correctly implementing a spinlock in C++" at https://rigtorp.se/spinlock/
 
 #include <internal/stl_atomic_internal.h>
-#include <internal/stl_utility_internal.h>
 #include <asm/cpu.h>
 
 
@@ -91,10 +90,11 @@ public:
 
     void lock() noexcept
     {
-        _Type __t = __lockedState;
-        while (_M_lock.load(__STD_NAMESPACE::memory_order_relaxed) != __unlockedState
-            && !_M_lock.compare_exchange_strong(__t, __STD_NAMESPACE::memory_order_acquire)) {
-            __cpu_relax();
+        while (_M_lock.exchange(__lockedState, __STD_NAMESPACE::memory_order_acquire) != __unlockedState) {
+            /* wait for lock to be released without generating cache misses */
+            while (_M_lock.load(__STD_NAMESPACE::memory_order_relaxed) != __unlockedState) {
+                __cpu_relax();
+            }
         }
     }
 
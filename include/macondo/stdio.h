@@ -29,6 +29,14 @@
 #include <stdarg.h>
 #include <stddef.h>
 
+/* flags of printf_conversion, the first five are printf flags */
+#define PRINTF_FLAG_MINUS        0x01
+#define PRINTF_FLAG_PLUS         0x02
+#define PRINTF_FLAG_SPACE        0x04
+#define PRINTF_FLAG_SPECIAL      0x08
+#define PRINTF_FLAG_ZERO         0x10
+#define PRINTF_PRECISION_OMITTED 0x40 /* "%.d" or "%.0d" */
+
 __BEGIN_DECLS
 __MACONDO_TEST_NAMESPACE_BEGIN
 
@@ -36,7 +44,425 @@ int vsnprintf(char *buf, size_t size, const char *fmt, va_list ap);
 int snprintf(char *buffer, size_t size, const char *fmt, ...);
 int sprintf(char *buffer, const char *fmt, ...);
 
+/**
+ * @brief printf_sink_fn - receives formatted output of vcbprintf
+ * @param ctx            - context passed to vcbprintf
+ * @param data           - chunk of output, not terminated
+ * @param len            - length of chunk
+ * @return                 0 to continue, nonzero stops formatting
+ */
+typedef int (*printf_sink_fn)(void *ctx, const char *data, size_t len);
+
+/**
+ * @brief vcbprintf - formats fmt handing output to sink in chunks, so output
+ *                    length isn't bounded by any buffer
+ * @return            number of characters given to sink
+ */
+int vcbprintf(printf_sink_fn sink, void *ctx, const char *fmt, va_list ap);
+int cbprintf(printf_sink_fn sink, void *ctx, const char *fmt, ...);
+
+/**
+ * @brief printf_conversion - literal text of format string followed by
+ *                            conversion, produced by macondo::format parser
+ */
+struct printf_conversion {
+    unsigned short text;     /* offset of text in format string */
+    unsigned short text_len; /* length of text */
+    char conversion;         /* d, i, u, o, x, X, p, s, c or 0 for text only */
+    unsigned char flags;     /* PRINTF_FLAG_* and PRINTF_PRECISION_OMITTED */
+    short width;             /* field width, -1 if not given */
+    short precision;         /* precision, -1 if not given */
+};
+
+/**
+ * @brief printf_arg - argument of conversion, integers are widened to 64 bits
+ *                     the way printf would read them
+ */
+union printf_arg {
+    long long i;
+    unsigned long long u;
+    const char *s;
+};
+
+int snprintf_parsed(char *buf, size_t size, const char *fmt, const struct printf_conversion *conversions,
+                    size_t count, const union printf_arg *args);
+
 __MACONDO_TEST_NAMESPACE_END
 __END_DECLS
 
+#if defined(__cplusplus) && __cplusplus >= 202002L
+
+namespace macondo
+{
+
+/**
+ * @ingroup  format
+ * @class macondo::format_string
+ * @brief format string literal passed as template argument of macondo::format
+ * @tparam _Size size of literal with terminator
+ */
+template<size_t _Size>
+struct format_string
+{
+    consteval format_string(const char (&__str)[_Size])
+    {
+        for (size_t __i = 0; __i < _Size; __i++) {
+            _M_data[__i] = __str[__i];
+        }
+    }
+
+    /* public, otherwise the type can't be template argument */
+    char _M_data[_Size];
+};
+
+namespace __detail
+{
+
+/* isn't constexpr, so the parser calling it fails the build with reason */
+void __invalid_format(const char *__reason);
+
+/* length modifiers, "hh" is 'H' and "ll" or "L" is 'q' */
+constexpr size_t __length_size(char __length)
+{
+    switch (__length) {
+        case 'H': return sizeof(char);
+        case 'h': return sizeof(short);
+        case 'l': return sizeof(long);
+        case 'q': return sizeof(long long);
+        case 'j': return sizeof(long long);
+        case 'z': return sizeof(size_t);
+        case 't': return sizeof(ptrdiff_t);
+        default: return sizeof(int);
+    }
+}
+
+struct __counts
+{
+    size_t _M_items;
+    size_t _M_args;
+};
+
+template<size_t _Items, size_t _Args>
+struct __parsed
+{
+    __MACONDO_TEST_NAMESPACE::printf_conversion _M_items[_Items];
+    /* conversion and length modifier of every argument, one extra for none */
+    char _M_arg_conversions[_Args + 1];
+    char _M_arg_lengths[_Args + 1];
+};
+
+consteval short __parse_number(const char *__fmt, size_t &__pos)
+{
+    int __value = 0;
+
+    while (__fmt[__pos] >= '0' && __fmt[__pos] <= '9') {
+        __value = __value * 10 + __fmt[__pos++] - '0';
+
+        if (__value > 0x7fff) {
+            __invalid_format("width or precision is too big");
+        }
+    }
+
+    return __value;
+}
+
+/*
+ * Splits format string into text and conversion pairs the way vsnprintf
+ * parses it. Without __parsed only counts pairs and arguments.
+ */
+template<typename _Parsed>
+consteval __counts __parse(const char *__fmt, _Parsed *__parsed)
+{
+    __counts __counts = {0, 0};
+    size_t __text = 0;
+    size_t __pos = 0;
+    auto __emit = [&](size_t __end, char __conversion, unsigned char __flags, short __width, short __precision) {
+        if (__end > 0xffff) {
+            __invalid_format("format string is too long");
+        }
+
+        if (__parsed != nullptr) {
+            auto &__item = __parsed->_M_items[__counts._M_items];
+            __item.text = __text;
+            __item.text_len = __end - __text;
+            __item.conversion = __conversion;
+            __item.flags = __flags;
+            __item.width = __width;
+            __item.precision = __precision;
+        }
+
+        ++__counts._M_items;
+    };
+
+    while (__fmt[__pos] != '\0') {
+        if (__fmt[__pos] != '%') {
+            ++__pos;
+            continue;
+        }
+
+        size_t __end = __pos++;
+        unsigned char __flags = 0;
+        short __width = -1;
+        short __precision = -1;
+        char __length = 0;
+
+        /* flags */
+        for (;; ++__pos) {
+            switch (__fmt[__pos]) {
+                case '#': __flags = (__flags | PRINTF_FLAG_SPECIAL) & ~PRINTF_FLAG_PLUS;
+                    continue;
+                case ' ': __flags = (__flags | PRINTF_FLAG_SPACE) & ~PRINTF_FLAG_ZERO;
+                    continue;
+                case '0': __flags |= PRINTF_FLAG_ZERO;
+                    continue;
+                case '-': __flags = (__flags | PRINTF_FLAG_MINUS) & ~PRINTF_FLAG_ZERO;
+                    continue;
+                case '+': __flags = (__flags | PRINTF_FLAG_PLUS) & ~PRINTF_FLAG_SPACE;
+                    continue;
+                default: break;
+            }
+
+            break;
+        }
+
+        /* field width */
+        if (__fmt[__pos] == '*') {
+            __invalid_format("width must be given in format string");
+        } else if (__fmt[__pos] >= '0' && __fmt[__pos] <= '9') {
+            __width = __parse_number(__fmt, __pos);
+        }
+
+        /* precision */
+        if (__fmt[__pos] == '.') {
+            __flags &= ~PRINTF_FLAG_ZERO;
+            ++__pos;
+
+            if (__fmt[__pos] >= '0' && __fmt[__pos] <= '9') {
+                __precision = __parse_number(__fmt, __pos);
+
+                if (__precision == 0) {
+                    __flags |= PRINTF_PRECISION_OMITTED;
+                }
+            } else if (__fmt[__pos] == '*') {
+                __invalid_format("precision must be given in format string");
+            } else if (__fmt[__pos] == '-') {
+                __precision = 0;
+                __parse_number(__fmt, ++__pos);
+            } else {
+                __flags |= PRINTF_PRECISION_OMITTED;
+            }
+        }
+
+        /* length modifier */
+        switch (__fmt[__pos]) {
+            case 'h':
+            case 'l':
+                __length = __fmt[__pos];
+
+                if (__fmt[__pos + 1] == __length) {
+                    __length = __length == 'h' ? 'H' : 'q';
+                    ++__pos;
+                }
+
+                ++__pos;
+                break;
+            case 'L': __length = 'q';
+                ++__pos;
+                break;
+            case 'j':
+            case 'z':
+            case 't': __length = __fmt[__pos++];
+                break;
+            default: break;
+        }
+
+        switch (__fmt[__pos]) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'c':
+            case 's':
+            case 'p':
+                if (__parsed != nullptr) {
+                    __parsed->_M_arg_conversions[__counts._M_args] = __fmt[__pos];
+                    __parsed->_M_arg_lengths[__counts._M_args] = __length;
+                }
+
+                __emit(__end, __fmt[__pos], __flags, __width, __precision);
+                ++__counts._M_args;
+                __text = ++__pos;
+                break;
+
+            case '%':
+                /* text goes on from the second '%' */
+                __emit(__end, '\0', 0, -1, -1);
+                __text = __pos++;
+                break;
+
+            case '\0': __invalid_format("format string ends with incomplete conversion");
+                break;
+            case 'n': __invalid_format("%n isn't supported");
+                break;
+            default: __invalid_format("unknown conversion");
+                break;
+        }
+    }
+
+    /* trailing text, maybe empty */
+    __emit(__pos, '\0', 0, -1, -1);
+    return __counts;
+}
+
+template<format_string _Format>
+consteval auto __parse_format()
+{
+    constexpr __counts __counts = __parse<__parsed<1, 0>>(_Format._M_data, nullptr);
+    __parsed<__counts._M_items, __counts._M_args> __result = {};
+
+    __parse(_Format._M_data, &__result);
+    return __result;
+}
+
+/* types printf can take, integers are types one can add to pointer */
+template<typename _Type>
+concept __integer = requires(_Type __value, const char *__ptr) { __ptr + __value; };
+
+template<typename _Type>
+inline constexpr bool __is_string = __is_same(_Type, const char *) || __is_same(_Type, char *);
+
+template<typename _Type>
+inline constexpr bool __is_pointer = __is_same(_Type, decltype(nullptr));
+
+template<typename _Type>
+inline constexpr bool __is_pointer<_Type *> = true;
+
+template<typename _Type>
+consteval void __check_arg(char __conversion, char __length)
+{
+    switch (__conversion) {
+        case 's':
+            if (!__is_string<_Type>) {
+                __invalid_format("%s takes char pointer");
+            }
+            break;
+
+        case 'p':
+            if (!__is_pointer<_Type>) {
+                __invalid_format("%p takes pointer");
+            }
+            break;
+
+        default:
+            if (!__integer<_Type>) {
+                __invalid_format("conversion takes integer");
+            }
+
+            /* smaller types are promoted to int, larger ones need length modifier */
+            if (__length == 0 || __length == 'h' || __length == 'H'
+                ? sizeof(_Type) > sizeof(int)
+                : sizeof(_Type) != __length_size(__length)) {
+                __invalid_format("integer size doesn't match length modifier");
+            }
+            break;
+    }
+}
+
+template<typename... _Args, size_t _Items, size_t _Count>
+consteval bool __check_args(const __parsed<_Items, _Count> &__parsed)
+{
+    if constexpr (sizeof...(_Args) != _Count) {
+        __invalid_format("number of arguments doesn't match format string");
+    } else {
+        size_t __i = 0;
+        ((__check_arg<_Args>(__parsed._M_arg_conversions[__i], __parsed._M_arg_lengths[__i]), ++__i), ...);
+    }
+
+    return true;
+}
+
+/* widens argument the way vsnprintf reads it with va_arg */
+template<typename _Type>
+inline __MACONDO_TEST_NAMESPACE::printf_arg __pack(_Type __value, char __conversion, char __length)
+{
+    __MACONDO_TEST_NAMESPACE::printf_arg __arg;
+
+    if constexpr (__is_string<_Type>) {
+        if (__conversion == 's') {
+            __arg.s = __value;
+            return __arg;
+        }
+    }
+
+    if constexpr (__is_pointer<_Type>) {
+        __arg.u = reinterpret_cast<size_t>(__value);
+    } else {
+        unsigned __shift = 64 - 8 * __length_size(__length);
+
+        __arg.u = static_cast<unsigned long long>(__value) << __shift;
+
+        if (__conversion == 'd' || __conversion == 'i' || __conversion == 'c') {
+            __arg.i = static_cast<long long>(__arg.u) >> __shift;
+        } else {
+            __arg.u >>= __shift;
+        }
+    }
+
+    return __arg;
+}
+
+} // namespace __detail
+
+/**
+ * @ingroup  format
+ * @brief format_n - snprintf with format string parsed and checked at compile
+ *                   time. Unknown conversions, "*" width or precision, %n and
+ *                   arguments which don't match conversions fail the build.
+ *                   Integers smaller than int need no length modifier, larger
+ *                   ones need the matching one, e.g. %zu for size_t
+ * @tparam _Format format string literal
+ * @param __buf    buffer for formatted output
+ * @param __size   sizeof buffer
+ * @param __args   arguments of conversions
+ * @return number of written characters like snprintf
+ *
+ * @example
+ * macondo::format_n<"irq %d at %p">(buf, size, irq, handler);
+ */
+template<format_string _Format, typename... _Args>
+int format_n(char *__buf, size_t __size, _Args... __args)
+{
+    static constexpr auto __parsed = __detail::__parse_format<_Format>();
+    static_assert(__detail::__check_args<_Args...>(__parsed));
+
+    __MACONDO_TEST_NAMESPACE::printf_arg __packed[sizeof...(_Args) + 1];
+    [[maybe_unused]] size_t __i = 0;
+
+    ((__packed[__i] = __detail::__pack(__args, __parsed._M_arg_conversions[__i], __parsed._M_arg_lengths[__i]), ++__i), ...);
+
+    return __MACONDO_TEST_NAMESPACE::snprintf_parsed(__buf, __size, _Format._M_data, __parsed._M_items,
+                                                    sizeof(__parsed._M_items) / sizeof(__parsed._M_items[0]),
+                                                    __packed);
+}
+
+/**
+ * @ingroup  format
+ * @brief format - format_n to array, size of array is the buffer size
+ *
+ * @example
+ * char buf[64];
+ * macondo::format<"%s: %u bytes">(buf, name, size);
+ */
+template<format_string _Format, size_t _Size, typename... _Args>
+int format(char (&__buf)[_Size], _Args... __args)
+{
+    return format_n<_Format>(__buf, _Size, __args...);
+}
+
+} // namespace macondo
+
+#endif /* __cplusplus */
+
 #endif //MACONDOOS_INCLUDE_MACONDO_STDIO_H_
\ No newline at end of file
@@ -0,0 +1,80 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MACONDOOS_INCLUDE_MACONDO_STRING_DISPATCH_H_
+#define MACONDOOS_INCLUDE_MACONDO_STRING_DISPATCH_H_
+
+#include "../defs.h"
+
+__BEGIN_DECLS
+
+/**
+ * @defgroup string_dispatch selection of string routine implementations
+ * @ingroup  strings
+ * @{
+ *
+ * memcpy, memmove, memset, memcmp, memchr, strlen and strchr call their
+ * implementation through a table of function pointers. Until
+ * string_dispatch_init() is called the table points to scalar routines which
+ * run on any CPU, so string functions may be used from the very first
+ * instruction of boot code.
+ */
+
+enum string_variant {
+    STRING_VARIANT_AUTO,   /* the best variant the CPU supports */
+    STRING_VARIANT_SCALAR, /* word at a time, runs on any CPU */
+    STRING_VARIANT_SIMD,   /* 128-bit vectors, see macondo/string_simd.h */
+};
+
+/**
+ * @brief string_dispatch_init - reads CPU ID registers (cpuid on test host)
+ *                               and routes string routines to the best
+ *                               variant. Call once at boot before other CPUs
+ *                               are started
+ */
+void string_dispatch_init(void);
+
+/**
+ * @brief string_dispatch_force - routes string routines to variant, meant to
+ *                                compare variants in benchmarks and tests.
+ *                                Other CPUs must not use string routines
+ *                                meanwhile
+ * @param variant               - variant to use
+ * @return                        0 on success, EINVAL if variant is unknown or
+ *                                ENOSYS if it isn't compiled in or the CPU
+ *                                doesn't support it
+ */
+int string_dispatch_force(enum string_variant variant);
+
+/**
+ * @brief string_dispatch_variant - returns variant in use, never AUTO
+ */
+enum string_variant string_dispatch_variant(void);
+
+/** @} */
+
+__END_DECLS
+
+#endif //MACONDOOS_INCLUDE_MACONDO_STRING_DISPATCH_H_
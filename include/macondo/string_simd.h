@@ -0,0 +1,62 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MACONDOOS_INCLUDE_MACONDO_STRING_SIMD_H_
+#define MACONDOOS_INCLUDE_MACONDO_STRING_SIMD_H_
+
+#include "../defs.h"
+#include <stddef.h>
+
+__BEGIN_DECLS
+
+/**
+ * @defgroup string_simd vectorized string routines
+ * @ingroup  strings
+ * @{
+ *
+ * 128-bit vector versions of the hottest string routines, compiled when libc
+ * is configured with MACONDO_LIBC_SIMD=ON. They live in their own translation
+ * unit which is the only part of libc built without +nosimd, the plain
+ * functions from string.h forward to them.
+ *
+ * Vectors are GCC generic vectors, so on AArch64 they become AdvSIMD code and
+ * on a host they become whatever the host has. Code calling them in kernel
+ * must have FP/SIMD state of the interrupted context saved.
+ *
+ * Semantics are the same as of the functions without simd_ prefix.
+ */
+
+void *simd_memcpy(void *__restrict__ dest, const void *__restrict__ src, size_t length);
+void *simd_memset(void *dest, int value, size_t length);
+void *simd_memchr(const void *memory, int needle, size_t count);
+int simd_memcmp(const void *first, const void *second, size_t length);
+size_t simd_strlen(const char *str);
+char *simd_strchr(const char *str, int needle);
+
+/** @} */
+
+__END_DECLS
+
+#endif //MACONDOOS_INCLUDE_MACONDO_STRING_SIMD_H_
@@ -30,13 +30,148 @@
 
 __BEGIN_DECLS
 
+/*
+ * Heap allocator. Free blocks are indexed with segregated size class lists,
+ * configure libc with MACONDO_MALLOC_TLSF=ON to use two-level segregated fit
+ * index with O(1) bounded malloc/free instead.
+ */
+
 void *mem_malloc(size_t size);
 void mem_free(void *ptr);
 void *mem_realloc(void *ptr, size_t size);
 void *mem_calloc(size_t count, size_t size);
+void *mem_aligned_alloc(size_t alignment, size_t size);
+int mem_posix_memalign(void **memptr, size_t alignment, size_t size);
 int mem_init(void *start, size_t sizeInBytes);
 void mem_dump();
 
+/**
+ * @brief mem_init_zeroed - same as mem_init() for region which is known to be
+ *                          zero filled, e.g. .bss or freshly cleared pages.
+ *                          mem_calloc() then doesn't clear memory heap has
+ *                          never handed out
+ * @param start           - beginning of the region
+ * @param sizeInBytes     - size of the region
+ * @return                  0 on success or EINVAL
+ */
+int mem_init_zeroed(void *start, size_t sizeInBytes);
+
+/* free blocks histogram class k counts blocks of [2^(k + 4), 2^(k + 5)) bytes */
+#define MEM_STATS_CLASSES 32
+
+struct mem_stats {
+    size_t heap_size;          /* bytes managed by heap including boundary tags */
+    size_t bytes_in_use;       /* allocated blocks including boundary tags */
+    size_t peak_bytes_in_use;  /* high watermark of bytes_in_use */
+    size_t bytes_free;         /* payload of free blocks */
+    size_t largest_free_block; /* payload of the largest free block */
+    size_t free_blocks;        /* number of free blocks */
+    size_t free_blocks_by_class[MEM_STATS_CLASSES];
+    size_t allocs;             /* successful malloc/calloc/aligned_alloc calls */
+    size_t frees;              /* free calls with valid pointer */
+    size_t reallocs;           /* realloc calls which reached the heap */
+    size_t failures;           /* allocations and reallocations failed */
+};
+
+/**
+ * @brief mem_get_stats - fills stats with heap figures
+ * @param stats         - where to store figures
+ *
+ * Figures are maintained by alloc and free paths so the call doesn't walk the
+ * heap. Blocks cached by per-CPU magazines are accounted as in use. External
+ * fragmentation can be estimated as 1 - largest_free_block / bytes_free.
+ */
+void mem_get_stats(struct mem_stats *stats);
+
+/*
+ * Arenas are independent heaps with their own lock, free lists and statistics,
+ * so a burst of allocations in one subsystem doesn't fragment others.
+ * mem_* functions above work on default arena set up by mem_init().
+ */
+struct mem_arena;
+
+/**
+ * @brief arena_init  - creates arena which manages memory region
+ * @param start       - beginning of the region, arena header is placed there
+ * @param sizeInBytes - size of the region
+ * @return              arena or NULL if region is too small
+ */
+struct mem_arena *arena_init(void *start, size_t sizeInBytes);
+void *arena_malloc(struct mem_arena *arena, size_t size);
+void arena_free(struct mem_arena *arena, void *ptr);
+void *arena_realloc(struct mem_arena *arena, void *ptr, size_t size);
+void arena_get_stats(struct mem_arena *arena, struct mem_stats *stats);
+void arena_dump(struct mem_arena *arena);
+
+/*
+ * Allocation tracing, compiled in when libc is configured with
+ * MACONDO_MALLOC_TRACE=ON. Every malloc/free/realloc/aligned_alloc call is
+ * logged to a ring buffer given by caller, the oldest records are overwritten.
+ * Pointers serve as ids of allocated objects, replay maps them to its own.
+ */
+#define MEM_TRACE_MALLOC        'm'
+#define MEM_TRACE_FREE          'f'
+#define MEM_TRACE_REALLOC       'r'
+#define MEM_TRACE_ALIGNED_ALLOC 'a'
+
+struct mem_trace_record {
+    unsigned long long timestamp; /* clock value or sequence number */
+    size_t size;                  /* requested size */
+    size_t alignment;             /* requested alignment of aligned_alloc */
+    size_t ptr;                   /* returned or freed pointer */
+    size_t old_ptr;               /* pointer passed to realloc */
+    int op;                       /* one of MEM_TRACE_* */
+};
+
+/**
+ * @brief mem_trace_start - starts logging allocator calls
+ * @param ring            - ring buffer for records
+ * @param capacity        - number of records ring can hold
+ * @param clock           - returns timestamps, if NULL sequence number is used
+ * @return                  0 on success, EINVAL or ENOSYS if tracing isn't
+ *                          compiled in
+ */
+int mem_trace_start(struct mem_trace_record *ring, size_t capacity,
+                    unsigned long long (*clock)(void));
+
+/**
+ * @brief mem_trace_stop - stops logging
+ * @return                 number of records logged since start, records beyond
+ *                         ring capacity are lost
+ */
+size_t mem_trace_stop();
+
+/**
+ * @brief mem_trace_read - copies the latest logged records oldest first
+ * @param records        - where to copy records
+ * @param count          - max number of records to copy
+ * @return                 number of records copied
+ */
+size_t mem_trace_read(struct mem_trace_record *records, size_t count);
+
+/**
+ * @brief mem_trace_dump - prints the latest logged records in alloc_replay
+ *                         text format, one record per line
+ */
+void mem_trace_dump();
+
+/**
+ * @brief mem_percpu_init - enables per-CPU magazine caches for small blocks
+ * @param cpu_count       - number of CPUs, not more than 4
+ * @param cpu_id          - returns id of current CPU in range [0, cpu_count)
+ * @return                  0 on success or EINVAL
+ *
+ * mem_init() disables caches, call it again after heap is reinitialized.
+ * Calls on a CPU whose id is out of range bypass caches and use the heap.
+ */
+int mem_percpu_init(unsigned int cpu_count, unsigned int (*cpu_id)(void));
+
+/**
+ * @brief mem_percpu_drain - gives all blocks cached by per-CPU magazines back
+ *                           to heap. Other CPUs must not allocate meanwhile
+ */
+void mem_percpu_drain();
+
 __END_DECLS
 
 #endif //STDLIB_H
\ No newline at end of file
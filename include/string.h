@@ -276,6 +276,19 @@ char *strpbrk(const char *str, const char *accept);
  */
 char *strstr(const char *haystack, const char *needle);
 
+/**
+ * @brief  memmem       - locate the first occurrence of needle in haystack,
+ *                        both are byte buffers and may contain null bytes
+ * @param  haystack     - buffer to search in
+ * @param  haystack_len - size of haystack
+ * @param  needle       - bytes to find
+ * @param  needle_len   - size of needle
+ * @return                pointer to the first occurrence or a null pointer if
+ *                        needle is not found. Empty needle is found at
+ *                        haystack
+ */
+void *memmem(const void *haystack, size_t haystack_len, const void *needle, size_t needle_len);
+
 /**
  * @brief  strtok    - a sequence of calls to strtok_r() breaks the string pointed to
  *                    by str into a sequence of tokens, each of which is delimited
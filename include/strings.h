@@ -114,6 +114,19 @@ int strcasecmp(const char *first, const char *second);
  */
 int strncasecmp(const char *first, const char *second, size_t n);
 
+/**
+ * @brief memcasecmp - compares length bytes of memory areas first and second,
+ *                     ignoring case of ASCII letters. Unlike strncasecmp it
+ *                     doesn't stop at NUL bytes
+ * @param first      - first memory area to compare
+ * @param second     - second memory area to compare
+ * @param length     - number of bytes to compare
+ * @return  difference of the first pair of bytes which differ after converting
+ *          them to lower case, or 0 if areas match
+ * @see memcmp, strncasecmp
+ */
+int memcasecmp(const void *first, const void *second, size_t length);
+
 /**
  * @brief  ffs - find first set bit
  * @param val  - integer number
@@ -135,6 +148,27 @@ int ffsl(long int val);
  */
 int ffsll(long long int val);
 
+/**
+ * @brief  fls - find last set bit
+ * @param val  - integer number
+ * @return the position of the last (most significant) bit set in the number i
+ */
+int fls(int val);
+
+/**
+ * @brief flsl - find last set bit
+ * @param val  - long number
+ * @return the position of the last (most significant) bit set in the number i
+ */
+int flsl(long int val);
+
+/**
+ * @brief flsll - find last set bit
+ * @param val   - long long number
+ * @return the position of the last (most significant) bit set in the number i
+ */
+int flsll(long long int val);
+
 __END_DECLS
 __MACONDO_TEST_NAMESPACE_END
 /** @} */
\ No newline at end of file
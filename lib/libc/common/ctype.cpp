@@ -0,0 +1,179 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <ctype.h>
+
+__BEGIN_DECLS
+
+/* Tables are computed at compile time from the classic range definitions */
+
+static constexpr unsigned short ctype_class(int c)
+{
+    unsigned short bits = 0;
+
+    if (c >= 'A' && c <= 'Z') {
+        bits |= _CTYPE_UPPER;
+    }
+
+    if (c >= 'a' && c <= 'z') {
+        bits |= _CTYPE_LOWER;
+    }
+
+    if (c >= '0' && c <= '9') {
+        bits |= _CTYPE_DIGIT | _CTYPE_XDIGIT;
+    }
+
+    if ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) {
+        bits |= _CTYPE_XDIGIT;
+    }
+
+    if ((c >= '\t' && c <= '\r') || c == ' ') {
+        bits |= _CTYPE_SPACE;
+    }
+
+    if (c == '\t' || c == ' ') {
+        bits |= _CTYPE_BLANK;
+    }
+
+    if ((c >= 33 && c <= 47) || (c >= 58 && c <= 64) || (c >= 91 && c <= 96) || (c >= 123 && c <= 126)) {
+        bits |= _CTYPE_PUNCT;
+    }
+
+    if ((c >= 0 && c <= 31) || c == 127) {
+        bits |= _CTYPE_CNTRL;
+    }
+
+    if (c >= 33 && c <= 126) {
+        bits |= _CTYPE_GRAPH;
+    }
+
+    if (c >= 32 && c <= 126) {
+        bits |= _CTYPE_PRINT;
+    }
+
+    return bits;
+}
+
+static constexpr signed char ctype_lower(int c)
+{
+    return c >= 'A' && c <= 'Z' ? 'a' - 'A' : 0;
+}
+
+static constexpr signed char ctype_upper(int c)
+{
+    return c >= 'a' && c <= 'z' ? 'A' - 'a' : 0;
+}
+
+#define TABLE_4(fn, c)   fn(c), fn(c + 1), fn(c + 2), fn(c + 3)
+#define TABLE_16(fn, c)  TABLE_4(fn, c), TABLE_4(fn, c + 4), TABLE_4(fn, c + 8), TABLE_4(fn, c + 12)
+#define TABLE_64(fn, c)  TABLE_16(fn, c), TABLE_16(fn, c + 16), TABLE_16(fn, c + 32), TABLE_16(fn, c + 48)
+#define TABLE_256(fn)    TABLE_64(fn, 0), TABLE_64(fn, 64), TABLE_64(fn, 128), TABLE_64(fn, 192)
+
+constinit const unsigned short __macondo_ctype_class[256] = {TABLE_256(ctype_class)};
+constinit const signed char __macondo_ctype_lower[256] = {TABLE_256(ctype_lower)};
+constinit const signed char __macondo_ctype_upper[256] = {TABLE_256(ctype_upper)};
+
+/* Out of line copies of the inline definitions in ctype.h */
+
+int toascii(int c) __THROW
+{
+    return c & 0x7f;
+}
+
+int isascii(int c) __THROW
+{
+    return (c & ~0x7f) == 0;
+}
+
+int isalnum(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & (_CTYPE_UPPER | _CTYPE_LOWER | _CTYPE_DIGIT) : 0;
+}
+
+int isalpha(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & (_CTYPE_UPPER | _CTYPE_LOWER) : 0;
+}
+
+int isblank(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & _CTYPE_BLANK : 0;
+}
+
+int iscntrl(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & _CTYPE_CNTRL : 0;
+}
+
+int isdigit(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & _CTYPE_DIGIT : 0;
+}
+
+int isgraph(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & _CTYPE_GRAPH : 0;
+}
+
+int islower(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & _CTYPE_LOWER : 0;
+}
+
+int isprint(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & _CTYPE_PRINT : 0;
+}
+
+int ispunct(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & _CTYPE_PUNCT : 0;
+}
+
+int isspace(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & _CTYPE_SPACE : 0;
+}
+
+int isupper(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & _CTYPE_UPPER : 0;
+}
+
+int isxdigit(int c) __THROW
+{
+    return (unsigned) c < 256 ? __macondo_ctype_class[c] & _CTYPE_XDIGIT : 0;
+}
+
+int tolower(int c) __THROW
+{
+    return (unsigned) c < 256 ? c + __macondo_ctype_lower[c] : c;
+}
+
+int toupper(int c) __THROW
+{
+    return (unsigned) c < 256 ? c + __macondo_ctype_upper[c] : c;
+}
+
+__END_DECLS
@@ -28,15 +28,16 @@
 #include <stdint.h>
 #include <string.h>
 #include <sys/types.h>
+#include <macondo/stdio.h>
 
 __USING_MACONDO_TEST_NAMESPACE
 
 #define MAX_NUMBER_LEN 66
 
 /**
- * @brief size of internal buffer for formatting functions
+ * @brief size of staging buffer vcbprintf hands to sink
  */
-#define SPRINTF_MAX_BUFFER_SIZE 1024
+#define CBPRINTF_CHUNK_SIZE 128
 
 struct PrintfSizeSpecifier {
     enum {
@@ -61,6 +62,11 @@ struct PrintfFormatFlag {
     };
 };
 
+static_assert(PRINTF_FLAG_MINUS == PrintfFormatFlag::kMinus && PRINTF_FLAG_PLUS == PrintfFormatFlag::kPlus
+              && PRINTF_FLAG_SPACE == PrintfFormatFlag::kSpace && PRINTF_FLAG_SPECIAL == PrintfFormatFlag::kSpecial
+              && PRINTF_FLAG_ZERO == PrintfFormatFlag::kZero,
+              "parsed conversions carry printf flags as they are");
+
 struct PrintfFormatArg {
     enum {
         kUnknown = 0,
@@ -118,22 +124,160 @@ static int parse_number(const char **str) {
     return result;
 }
 
+/* "00" to "99", decimal numbers are converted two digits per division */
+static const char kDecimalPairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const unsigned long long kPowersOf10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL,
+    10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+    1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+    10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+/* Number of decimal digits of non zero number, log10 is estimated from bit length */
+static inline int decimal_digits(unsigned long long number) {
+    int log10 = ((64 - __builtin_clzll(number)) * 1233) >> 12;
+
+    return log10 + (number >= kPowersOf10[log10]);
+}
+
+/**
+ * @brief convert_number - writes digits of non zero number without any padding
+ * @param buffer         - destination buffer, MAX_NUMBER_LEN bytes
+ * @param number         - the number to convert
+ * @param radix          - 8, 10 or 16
+ * @param digits         - digits to use for hexadecimal numbers
+ * @return number of digits written
+ *
+ * Length is computed first and digits are written from the end, hexadecimal
+ * and octal digits are taken by shifts and decimal ones in pairs, so there is
+ * one division by constant per two digits.
+ */
+static int convert_number(char *buffer, unsigned long long number, int radix, const char *digits) {
+    int len;
+    char *p;
+
+    if (radix == 16) {
+        len = (67 - __builtin_clzll(number)) / 4;
+
+        for (p = buffer + len; number != 0; number >>= 4) {
+            *--p = digits[number & 0xf];
+        }
+    } else if (radix == 8) {
+        len = (66 - __builtin_clzll(number)) / 3;
+
+        for (p = buffer + len; number != 0; number >>= 3) {
+            *--p = '0' + (number & 0x7);
+        }
+    } else {
+        len = decimal_digits(number);
+        p = buffer + len;
+
+        while (number >= 100) {
+            unsigned pair = (number % 100) * 2;
+            number /= 100;
+            *--p = kDecimalPairs[pair + 1];
+            *--p = kDecimalPairs[pair];
+        }
+
+        if (number >= 10) {
+            *--p = kDecimalPairs[number * 2 + 1];
+            *--p = kDecimalPairs[number * 2];
+        } else {
+            *--p = '0' + number;
+        }
+    }
+
+    return len;
+}
+
+/*
+ * Destination of formatted output. Without sink buffer is the caller buffer
+ * and output is cut when it's full, with sink buffer is a staging area which
+ * is handed to sink every time it fills up.
+ */
+class Output {
+public:
+    Output(char *buffer, size_t capacity, printf_sink_fn sink = nullptr, void *ctx = nullptr)
+        : buffer_(buffer), capacity_(capacity), sink_(sink), ctx_(ctx) {}
+
+    void put(char c) {
+        if ((pos_ < capacity_ || flush()) && !stopped_) {
+            buffer_[pos_++] = c;
+        }
+    }
+
+    void write(const char *data, size_t len) {
+        while (len > 0 && (pos_ < capacity_ || flush()) && !stopped_) {
+            /* long chunks go to sink as they are */
+            if (sink_ != nullptr && pos_ == 0 && len >= capacity_) {
+                stopped_ = sink_(ctx_, data, len) != 0;
+                flushed_ += len;
+                return;
+            }
+
+            size_t chunk = capacity_ - pos_ < len ? capacity_ - pos_ : len;
+            memcpy(buffer_ + pos_, data, chunk);
+            pos_ += chunk;
+            data += chunk;
+            len -= chunk;
+        }
+    }
+
+    /* gives staging buffer to sink, false if output doesn't accept more */
+    bool flush() {
+        if (sink_ == nullptr) {
+            stopped_ = pos_ == capacity_;
+            return !stopped_;
+        }
+
+        if (!stopped_ && pos_ > 0) {
+            stopped_ = sink_(ctx_, buffer_, pos_) != 0;
+            flushed_ += pos_;
+            pos_ = 0;
+        }
+
+        return !stopped_;
+    }
+
+    bool stopped() const {
+        return stopped_;
+    }
+
+    /* characters written so far */
+    size_t count() const {
+        return flushed_ + pos_;
+    }
+
+private:
+    char *buffer_;
+    size_t capacity_;
+    printf_sink_fn sink_;
+    void *ctx_;
+    size_t pos_ = 0;
+    size_t flushed_ = 0;
+    bool stopped_ = false;
+};
+
 /**
- * @brief format_number - implementing format number and output string has length not more than max_size
- * @param buffer        - destination buffer
+ * @brief format_number - formats number with sign, prefix and padding
+ * @param out           - where to write
  * @param arg           - the number to format
  * @param formatSpec    - format spec with printf flags etc
- * @param max_size      - maximum allowed length
- * @return length of formatted number
  */
-static size_t format_number(char *buffer, unsigned long long arg, FormatSpec &formatSpec, size_t max_size) {
+static void format_number(Output &out, unsigned long long arg, FormatSpec &formatSpec) {
     if (formatSpec.flags.checkFlag(PrintfFormatArg::kPrecisionOmitted)) {
         if (formatSpec.field_width <= 0) {
-            return 0;
+            return;
         }
     }
 
-    size_t len = 0;
     unsigned long long number = arg;
     int number_len = 0;
     int sign = -1;
@@ -157,24 +301,15 @@ static size_t format_number(char *buffer, unsigned long long arg, FormatSpec &fo
         }
     }
 
-    /* Generate number array in reverse order */
     if (number != 0) {
-        while (number != 0) {
-            unsigned long long n = number % formatSpec.radix;
-            number /= formatSpec.radix;
-            num_str[number_len++] = digits[n];
-        }
+        number_len = convert_number(num_str, number, formatSpec.radix, digits);
     } else {
         num_str[number_len++] = formatSpec.flags.checkFlag(PrintfFormatArg::kPrecisionOmitted) ? ' ' : '0';
 
         /* do not paint 0x0 or 00 ??? */
         if (formatSpec.printfFormatFlags.checkFlag(PrintfFormatFlag::kSpecial)) {
-            if (len < max_size) {
-                *buffer++ = '0';
-                ++len;
-            }
-
-            return len;
+            out.put('0');
+            return;
         }
     }
 
@@ -200,85 +335,62 @@ static size_t format_number(char *buffer, unsigned long long arg, FormatSpec &fo
     if (!formatSpec.printfFormatFlags.checkFlag(PrintfFormatFlag::kMinus)) {
         if (!formatSpec.printfFormatFlags.checkFlag(PrintfFormatFlag::kZero)) {
             /* leading padding */
-            while (--formatSpec.field_width >= 0 && len < max_size) {
-                *buffer++ = ' ';
-                ++len;
+            while (--formatSpec.field_width >= 0) {
+                out.put(' ');
             }
         }
     }
     /* write sign or space depends from format flags */
-    if (sign > 0 && len < max_size) {
-        *buffer++ = sign;
-        ++len;
+    if (sign > 0) {
+        out.put(sign);
     }
 
     /* handle alternate form prefix here */
     if (formatSpec.printfFormatFlags.checkFlag(PrintfFormatFlag::kSpecial)) {
         if (formatSpec.radix != 10) {
-            if (len < max_size) {
-                *buffer++ = '0';
-                ++len;
-            }
+            out.put('0');
+
             if (formatSpec.radix == 16) {
-                if (len < max_size) {
-                    *buffer++ = formatSpec.printfFormatFlags.checkFlag(PrintfFormatFlag::kHugeNumbers) ? 'X' : 'x';
-                    ++len;
-                }
+                out.put(formatSpec.printfFormatFlags.checkFlag(PrintfFormatFlag::kHugeNumbers) ? 'X' : 'x');
             }
         }
     }
 
     /* prepend zeros if min precision requires it */
-    while (--formatSpec.precision >= 0 && len < max_size) {
-        *buffer++ = '0';
-        ++len;
+    while (--formatSpec.precision >= 0) {
+        out.put('0');
     }
 
     /* padding after sign ??? what if no zero ??? */
     if (!formatSpec.printfFormatFlags.checkFlag(PrintfFormatFlag::kMinus)) {
         char pad = formatSpec.printfFormatFlags.checkFlag(PrintfFormatFlag::kZero) ? '0' : ' ';
 
-        while (--formatSpec.field_width >= 0 && len < max_size) {
-            *buffer++ = pad;
-            ++len;
+        while (--formatSpec.field_width >= 0) {
+            out.put(pad);
         }
     }
 
-    while (--formatSpec.precision >= 0 && len < max_size) {
-        *buffer++ = '0';
-        ++len;
-    }
     /* write number itself */
-    for (int i = number_len - 1; i >= 0 && len < max_size; --i, --formatSpec.precision, ++len) {
-        *buffer++ = num_str[i];
-    }
+    out.write(num_str, number_len);
 
     /* trailing padding */
-    while (--formatSpec.field_width >= 0 && len < max_size) {
-        *buffer++ = ' ';
-        ++len;
+    while (--formatSpec.field_width >= 0) {
+        out.put(' ');
     }
-
-    *buffer = '\0';
-    return len;
 }
 
-static size_t format_char(char *buffer, int arg, FormatSpec &formatSpec, size_t max_size) {
-    size_t len = 1;
-
+static void format_char(Output &out, int arg, FormatSpec &formatSpec) {
     if (!formatSpec.printfFormatFlags.checkFlag(PrintfFormatFlag::kMinus)) {
-        for (; (formatSpec.field_width > 1) && (len < max_size); formatSpec.field_width--, len++) {
-            *buffer++ = ' ';
+        for (; formatSpec.field_width > 1; formatSpec.field_width--) {
+            out.put(' ');
         }
     }
 
-    *buffer++ = arg;
+    out.put(arg);
 
-    for (; (formatSpec.field_width > 1) && (len < max_size); formatSpec.field_width--, len++) {
-        *buffer++ = ' ';
+    for (; formatSpec.field_width > 1; formatSpec.field_width--) {
+        out.put(' ');
     }
-
-    return len;
 }
 
 template<typename _Type>
@@ -304,7 +416,7 @@ long long read_signed_number(const FormatSpec &formatSpec, _Type &ap) {
         case PrintfSizeSpecifier::kShort:value = static_cast<signed short> (va_arg(ap, int));
             break;
 
-        case PrintfSizeSpecifier::kSizeT:value = static_cast<ssize_t> (va_arg(ap, int));
+        case PrintfSizeSpecifier::kSizeT:value = va_arg(ap, ssize_t);
             break;
         default:value = va_arg(ap, int);
     }
@@ -318,7 +430,7 @@ unsigned long long read_unsigned_number(const FormatSpec &formatSpec, _Type &ap)
 
     switch (formatSpec.printfSizeSpecifier.flags) {
 
-        case PrintfSizeSpecifier::kChar:value = static_cast<signed char> (va_arg(ap, unsigned int));
+        case PrintfSizeSpecifier::kChar:value = static_cast<unsigned char> (va_arg(ap, unsigned int));
             break;
 
         case PrintfSizeSpecifier::kIntUintMax:value = va_arg(ap, uintmax_t);
@@ -336,7 +448,7 @@ unsigned long long read_unsigned_number(const FormatSpec &formatSpec, _Type &ap)
         case PrintfSizeSpecifier::kShort:value = static_cast<unsigned short> (va_arg(ap, unsigned int));
             break;
 
-        case PrintfSizeSpecifier::kSizeT:value = static_cast<size_t> (va_arg(ap, unsigned int));
+        case PrintfSizeSpecifier::kSizeT:value = va_arg(ap, size_t);
             break;
         default:value = va_arg(ap, unsigned int);
     }
@@ -344,15 +456,13 @@ unsigned long long read_unsigned_number(const FormatSpec &formatSpec, _Type &ap)
     return value;
 }
 
-static size_t format_string(char *buffer, const char *str, FormatSpec &formatSpec, size_t max_size) {
-    size_t len = 0;
-
+static void format_string(Output &out, const char *str, FormatSpec &formatSpec) {
     if (str) {
         int str_len = strlen(str);
 
         if (formatSpec.flags.checkFlag(PrintfFormatArg::kPrecisionOmitted)) {
             if (formatSpec.field_width <= 0) {
-                return 0;
+                return;
             }
         } else if (formatSpec.precision <= 0 || formatSpec.precision > str_len) {
             formatSpec.precision = str_len;
@@ -363,57 +473,25 @@ static size_t format_string(char *buffer, const char *str, FormatSpec &formatSpe
         }
 
         if (!formatSpec.printfFormatFlags.checkFlag(PrintfFormatFlag::kMinus)) {
-            for (; formatSpec.field_width > 0 && len < max_size; formatSpec.field_width--, len++) {
-                *buffer++ = ' ';
+            for (; formatSpec.field_width > 0; formatSpec.field_width--) {
+                out.put(' ');
             }
         }
 
-        for (; formatSpec.precision-- > 0 && len < max_size; len++) {
-            *buffer++ = *str++;
+        if (formatSpec.precision > 0) {
+            out.write(str, formatSpec.precision);
         }
 
-        for (; formatSpec.field_width > 0 && len < max_size; formatSpec.field_width--, len++) {
-            *buffer++ = ' ';
+        for (; formatSpec.field_width > 0; formatSpec.field_width--) {
+            out.put(' ');
         }
     } else {
         /* just print (null) */
-        if (len < max_size) {
-            *buffer++ = '(';
-            len++;
-        }
-
-        if (len < max_size) {
-            *buffer++ = 'n';
-            len++;
-        }
-
-        if (len < max_size) {
-            *buffer++ = 'u';
-            len++;
-        }
-
-        if (len < max_size) {
-            *buffer++ = 'l';
-            len++;
-        }
-
-        if (len < max_size) {
-            *buffer++ = 'l';
-            len++;
-        }
-
-        if (len < max_size) {
-            *buffer++ = ')';
-            len++;
-        }
+        out.write("(null)", 6);
     }
-
-    return len;
 }
 
-static size_t format_pointer(char *buffer, unsigned long long addr, FormatSpec &formatSpec, size_t max_size) {
-    size_t len = 0;
-
+static void format_pointer(Output &out, unsigned long long addr, FormatSpec &formatSpec) {
     formatSpec.reset();
     formatSpec.radix = 16;
     formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kSpecial);
@@ -421,35 +499,243 @@ static size_t format_pointer(char *buffer, unsigned long long addr, FormatSpec &
     formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kMinus);
 
     if (addr != 0) {
-        len = format_number(buffer, addr, formatSpec, max_size);
+        format_number(out, addr, formatSpec);
     } else {
-        if (len < max_size) {
-            *buffer++ = '(';
-            len++;
+        out.write("(nil)", 5);
+    }
+}
+
+/**
+ * @brief format_value - formats argument of conversion
+ * @param out          - where to write
+ * @param conversion   - one of d, i, u, o, x, X, p, s, c
+ * @param arg          - the argument, integers are already widened to 64 bits
+ * @param formatSpec   - format spec with printf flags etc
+ */
+static void format_value(Output &out, char conversion, printf_arg arg, FormatSpec &formatSpec) {
+    switch (conversion) {
+        case 'X':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kHugeNumbers);
+            [[fallthrough]];
+        case 'x':formatSpec.radix = 16;
+            format_number(out, arg.u, formatSpec);
+            break;
+
+        case 'p':format_pointer(out, arg.u, formatSpec);
+            break;
+
+        case 'd':[[fallthrough]];
+        case 'i':formatSpec.radix = 10;
+            formatSpec.flags.setFlag(PrintfFormatArg::kSignedValue);
+
+            if (arg.i < 0) {
+                formatSpec.flags.setFlag(PrintfFormatArg::kNegativeValue);
+                arg.u = 0 - arg.u;
+            }
+
+            format_number(out, arg.u, formatSpec);
+            break;
+
+        case 'o':formatSpec.radix = 8;
+            [[fallthrough]];
+        case 'u':format_number(out, arg.u, formatSpec);
+            break;
+
+        case 's':format_string(out, arg.s, formatSpec);
+            break;
+
+        case 'c':format_char(out, arg.i, formatSpec);
+            break;
+
+        default:break;
+    }
+}
+
+/* Formats fmt to out until format string ends or out stops accepting output */
+static void format(Output &out, const char *fmt, va_list ap) {
+    FormatSpec formatSpec;
+    bool isNegative = false;
+
+    while (*fmt != '\0' && !out.stopped()) {
+        if (*fmt != '%') {
+            const char *text = fmt;
+
+            while (*fmt != '\0' && *fmt != '%') {
+                ++fmt;
+            }
+
+            out.write(text, fmt - text);
+            continue;
         }
 
-        if (len < max_size) {
-            *buffer++ = 'n';
-            len++;
+        formatSpec.reset();
+
+        /* handle format flags */
+        while (*fmt++ != '\0') {
+            switch (*fmt) {
+                case '#':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kSpecial);
+                    formatSpec.printfFormatFlags.clearFlag(PrintfFormatFlag::kPlus);
+                    continue;
+
+                case ' ':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kSpace);
+                    formatSpec.printfFormatFlags.clearFlag(PrintfFormatFlag::kZero);
+                    continue;
+
+                case '0':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kZero);
+                    continue;
+
+                case '-':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kMinus);
+                    formatSpec.printfFormatFlags.clearFlag(PrintfFormatFlag::kZero);
+                    continue;
+
+                case '+':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kPlus);
+                    formatSpec.printfFormatFlags.clearFlag(PrintfFormatFlag::kSpace);
+                    continue;
+
+                default:break;
+            }
+
+            break;
         }
 
-        if (len < max_size) {
-            *buffer++ = 'i';
-            len++;
+        /* handle field width */
+        isNegative = false;
+
+        if (*fmt == '-') {
+            ++fmt;
+            isNegative = true;
+        } else if (isdigit(*fmt)) {
+            formatSpec.field_width = parse_number(&fmt);
+        } else if (*fmt == '*') {
+            ++fmt;
+            formatSpec.field_width = va_arg(ap, int);
+
+            if (formatSpec.field_width < 0) {
+                formatSpec.field_width = -formatSpec.field_width;
+                isNegative = true;
+            }
         }
 
-        if (len < max_size) {
-            *buffer++ = 'l';
-            len++;
+        if (isNegative) {
+            formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kMinus);
         }
 
-        if (len < max_size) {
-            *buffer++ = ')';
-            len++;
+        /* handle precision */
+        if (*fmt == '.') {
+            ++fmt;
+            formatSpec.printfFormatFlags.clearFlag(PrintfFormatFlag::kZero);
+
+            if (isdigit(*fmt)) {
+                formatSpec.precision = parse_number(&fmt);
+                /* catch explicit set of precision to 0 via "%.0" */
+                if (formatSpec.precision == 0) {
+                    formatSpec.flags.setFlag(PrintfFormatArg::kPrecisionOmitted);
+                }
+            } else if (*fmt == '*') {
+                ++fmt;
+                formatSpec.precision = va_arg(ap, int);
+            } else if (*fmt == '-') { /* Should I catch '+' here ??? */
+                /* Negative precision should be set as zero */
+                formatSpec.precision = 0;
+                /* just skip digits */
+                parse_number(&++fmt);
+            } else {
+                formatSpec.flags.setFlag(PrintfFormatArg::kPrecisionOmitted);
+            }
         }
-    }
 
-    return len;
+        /* handle size specifier */
+        switch (*fmt) {
+            case 'l': {
+                char c = *fmt++;
+
+                if (*fmt != c) {
+                    formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kLong);
+                    --fmt;
+                } else {
+                    formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kLongLong);
+                }
+
+                ++fmt;
+                break;
+            }
+            case 'h': {
+                char c = *fmt++;
+
+                if (*fmt != c) {
+                    formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kShort);
+                    --fmt;
+                } else {
+                    formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kChar);
+                }
+
+                ++fmt;
+                break;
+            }
+            case 'j':formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kIntUintMax);
+                ++fmt;
+                break;
+            case 't':formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kPtrDiffT);
+                ++fmt;
+                break;
+            case 'L':formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kLongLong);
+                ++fmt;
+                break;
+            case 'z':formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kSizeT);
+                ++fmt;
+                break;
+            default:break;
+        }
+
+        /* handle conversion specifier */
+        printf_arg arg;
+
+        switch (*fmt) {
+            case '\0':
+                /* format string ends with incomplete conversion */
+                return;
+
+            case 'd':[[fallthrough]];
+            case 'i':arg.i = read_signed_number(formatSpec, ap);
+                format_value(out, *fmt, arg, formatSpec);
+                break;
+
+            case 'X':[[fallthrough]];
+            case 'x':[[fallthrough]];
+            case 'o':[[fallthrough]];
+            case 'u':arg.u = read_unsigned_number(formatSpec, ap);
+                format_value(out, *fmt, arg, formatSpec);
+                break;
+
+            case 'p':arg.u = reinterpret_cast<uintptr_t>(va_arg(ap, void*));
+                format_value(out, *fmt, arg, formatSpec);
+                break;
+
+            case 's':arg.s = va_arg(ap, const char*);
+                format_value(out, *fmt, arg, formatSpec);
+                break;
+
+            case 'c':arg.i = va_arg(ap, int);
+                format_value(out, *fmt, arg, formatSpec);
+                break;
+
+            case 'n': {
+                int *ptr = va_arg(ap, int*);
+
+                if (ptr) {
+                    *ptr = out.count();
+                }
+            }
+                break;
+
+            case '%':out.put('%');
+                break;
+
+            default:out.put(*fmt);
+                break;
+        }
+
+        ++fmt;
+    }
 }
 
 __BEGIN_DECLS
@@ -464,7 +750,7 @@ __BEGIN_DECLS
  * @brief vsnprintf    - formatted output conversion
  * @param buf          - buffer for formatted output
  * @param size         - sizeof buffer
- * @param fmt          - printf format string
+ * @param fmt          - printf format string, must not be NULL
  * @param ap           - arguments
  * @return number of written characters (len of formatted output string)
  *
@@ -492,227 +778,97 @@ __BEGIN_DECLS
  * n    - printed characters number at the moment \n
  */
 int vsnprintf(char *buf, size_t size, const char *fmt, va_list ap) {
-    if (size > 1 && buf && fmt) {
-        char *p_buf = buf;
-        FormatSpec formatSpec;
-        bool isNegative = false;
-        size_t len = 0;
-        --size;
-
-        if (size == 0) {
-            return size;
-        }
-
-        for (size_t sz = 0; (sz < size) && (*fmt != '\0'); ++sz, ++fmt) {
-            if (*fmt != '%') {
-                *p_buf++ = *fmt;
-                continue;
-            }
-
-            formatSpec.reset();
-
-            /* handle format flags */
-            while (*fmt++ != '\0') {
-                switch (*fmt) {
-                    case '#':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kSpecial);
-                        formatSpec.printfFormatFlags.clearFlag(PrintfFormatFlag::kPlus);
-                        continue;
-
-                    case ' ':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kSpace);
-                        formatSpec.printfFormatFlags.clearFlag(PrintfFormatFlag::kZero);
-                        continue;
-
-                    case '0':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kZero);
-                        continue;
-
-                    case '-':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kMinus);
-                        formatSpec.printfFormatFlags.clearFlag(PrintfFormatFlag::kZero);
-                        continue;
-
-                    case '+':formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kPlus);
-                        formatSpec.printfFormatFlags.clearFlag(PrintfFormatFlag::kSpace);
-                        continue;
-
-                    default:break;
-                }
-
-                break;
-            }
-
-            /* handle field width */
-            isNegative = false;
-
-            if (*fmt == '-') {
-                ++fmt;
-                isNegative = true;
-            } else if (isdigit(*fmt)) {
-                formatSpec.field_width = parse_number(&fmt);
-            } else if (*fmt == '*') {
-                ++fmt;
-                formatSpec.field_width = va_arg(ap, int);
-
-                if (formatSpec.field_width < 0) {
-                    formatSpec.field_width = -formatSpec.field_width;
-                    isNegative = true;
-                }
-            }
-
-            if (isNegative) {
-                formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kMinus);
-            }
-
-            /* handle precision */
-            if (*fmt == '.') {
-                ++fmt;
-                formatSpec.printfFormatFlags.clearFlag(PrintfFormatFlag::kZero);
-
-                if (isdigit(*fmt)) {
-                    formatSpec.precision = parse_number(&fmt);
-                    /* catch explicit set of precision to 0 via "%.0" */
-                    if (formatSpec.precision == 0) {
-                        formatSpec.flags.setFlag(PrintfFormatArg::kPrecisionOmitted);
-                    }
-                } else if (*fmt == '*') {
-                    ++fmt;
-                    formatSpec.precision = va_arg(ap, int);
-                } else if (*fmt == '-') { /* Should I catch '+' here ??? */
-                    /* Negative precision should be set as zero */
-                    formatSpec.precision = 0;
-                    /* just skip digits */
-                    parse_number(&++fmt);
-                } else {
-                    formatSpec.flags.setFlag(PrintfFormatArg::kPrecisionOmitted);
-                }
-            }
-
-            /* handle size specifier */
-            switch (*fmt) {
-                case 'l': {
-                    char c = *fmt++;
-
-                    if (*fmt != c) {
-                        formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kLong);
-                        --fmt;
-                    } else {
-                        formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kLongLong);
-                    }
-
-                    ++fmt;
-                    break;
-                }
-                case 'h': {
-                    char c = *fmt++;
-
-                    if (*fmt != c) {
-                        formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kShort);
-                        --fmt;
-                    } else {
-                        formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kChar);
-                    }
-
-                    ++fmt;
-                    break;
-                }
-                case 'j':formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kIntUintMax);
-                    ++fmt;
-                    break;
-                case 't':formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kPtrDiffT);
-                    ++fmt;
-                    break;
-                case 'L':formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kLongLong);
-                    ++fmt;
-                    break;
-                case 'z':formatSpec.printfSizeSpecifier.setFlag(PrintfSizeSpecifier::kSizeT);
-                    ++fmt;
-                    break;
-                default:break;
-            }
-
-            len = 0;
-            /* handle conversion specifier */
-            switch (*fmt) {
-                case 'X' :formatSpec.printfFormatFlags.setFlag(PrintfFormatFlag::kHugeNumbers);
-                    [[fallthrough]];
-                case 'x': {
-                    formatSpec.radix = 16;
-                    unsigned long long value = read_unsigned_number(formatSpec, ap);
-                    len = format_number(p_buf, value, formatSpec, size - sz);
-                }
-                    break;
-
-                case 'p': {
-                    unsigned long long value = read_unsigned_number(formatSpec, ap);
-                    len = format_pointer(p_buf, value, formatSpec, size - sz);
-                }
-                    break;
-
-                case 'd':[[fallthrough]];
-                case 'i': {
-                    formatSpec.radix = 10;
-                    long long value = read_signed_number(formatSpec, ap);
-
-                    formatSpec.flags.setFlag(PrintfFormatArg::kSignedValue);
-
-                    if (value < 0) {
-                        formatSpec.flags.setFlag(PrintfFormatArg::kNegativeValue);
-                        value = -value;
-                    }
+    if (buf == NULL || size == 0) {
+        return 0;
+    }
 
-                    len = format_number(p_buf, value, formatSpec, size - sz);
-                }
-                    break;
+    Output out(buf, size - 1);
 
-                case 'o':formatSpec.radix = 8;
-                    [[fallthrough]];
-                case 'u': {
-                    unsigned long long value = read_unsigned_number(formatSpec, ap);
-                    len = format_number(p_buf, value, formatSpec, size - sz);
-                }
-                    break;
+    format(out, fmt, ap);
+    buf[out.count()] = '\0';
+    return out.count();
+}
 
-                case 's': {
-                    const char *str = va_arg(ap, const char*);
-                    len = format_string(p_buf, str, formatSpec, size - sz);
-                }
-                    break;
+/**
+ * @see macondo::format
+ * @brief snprintf_parsed - formatted output conversion of format string
+ *                          parsed beforehand
+ * @param buf             - buffer for formatted output
+ * @param size            - sizeof buffer
+ * @param fmt             - format string conversions refer to
+ * @param conversions     - literal text and conversion pairs
+ * @param count           - number of conversions
+ * @param args            - an argument for every conversion which isn't 0
+ * @return number of written characters like vsnprintf
+ */
+int snprintf_parsed(char *buf, size_t size, const char *fmt, const struct printf_conversion *conversions,
+                    size_t count, const union printf_arg *args) {
+    if (buf == NULL || size == 0) {
+        return 0;
+    }
 
-                case 'c': {
-                    int c = va_arg(ap, int);
-                    len = format_char(p_buf, c, formatSpec, size - sz);
-                }
-                    break;
+    Output out(buf, size - 1);
+    FormatSpec formatSpec;
 
-                case 'n': {
-                    size_t *ptr = va_arg(ap, size_t*);
+    for (size_t i = 0; i < count && !out.stopped(); i++) {
+        const printf_conversion &conversion = conversions[i];
 
-                    if (ptr) {
-                        *ptr = p_buf - buf;
-                    }
-                }
-                    break;
+        out.write(fmt + conversion.text, conversion.text_len);
 
-                case '%':*p_buf++ = '%';
-                    break;
+        if (conversion.conversion != '\0') {
+            formatSpec.reset();
+            formatSpec.printfFormatFlags = conversion.flags & ~PRINTF_PRECISION_OMITTED;
+            formatSpec.field_width = conversion.width;
+            formatSpec.precision = conversion.precision;
 
-                default:
-                    if (sz++ < size) {
-                        *p_buf++ = *fmt;
-                    }
-                    break;
+            if (conversion.flags & PRINTF_PRECISION_OMITTED) {
+                formatSpec.flags.setFlag(PrintfFormatArg::kPrecisionOmitted);
             }
 
-            sz += len;
-            p_buf += len;
+            format_value(out, conversion.conversion, *args++, formatSpec);
         }
+    }
+
+    buf[out.count()] = '\0';
+    return out.count();
+}
 
-        *p_buf = '\0';
-        return p_buf - buf;
-    } else if (buf) {
-        *buf = '\0';
+/**
+ * @see vsnprintf
+ * @brief vcbprintf - formatted output conversion to sink
+ * @param sink      - receives output in chunks
+ * @param ctx       - passed to sink
+ * @param fmt       - printf format string
+ * @param ap        - arguments
+ * @return number of characters given to sink
+ *
+ * Output is staged in \link CBPRINTF_CHUNK_SIZE \endlink bytes on stack,
+ * literal text which doesn't fit there goes to sink straight from fmt.
+ */
+int vcbprintf(printf_sink_fn sink, void *ctx, const char *fmt, va_list ap) {
+    if (sink == NULL || fmt == NULL) {
         return 0;
     }
 
-    return 0;
+    char chunk[CBPRINTF_CHUNK_SIZE];
+    Output out(chunk, sizeof(chunk), sink, ctx);
+
+    format(out, fmt, ap);
+    out.flush();
+    return out.count();
+}
+
+/**
+ * @see vcbprintf
+ * @brief cbprintf - formatted output conversion to sink
+ */
+int cbprintf(printf_sink_fn sink, void *ctx, const char *fmt, ...) {
+    int res = -1;
+    va_list ap;
+    va_start(ap, fmt);
+    res = vcbprintf(sink, ctx, fmt, ap);
+    va_end(ap);
+    return res;
 }
 
 /**
@@ -737,19 +893,17 @@ int snprintf(char *buffer, size_t size, const char *fmt, ...) {
 /**
  * @see snprintf
  * @brief sprintf - formatted output conversion
- * @param buffer  - buffer for formatted output
+ * @param buffer  - buffer for formatted output, must be big enough
  * @return        - number of written characters (len of formatted output string)
- *
- * Uses internally \link snprintf \endlink with \link SPRINTF_MAX_BUFFER_SIZE \endlink buffer
  */
 int sprintf(char *buffer, const char *fmt, ...) {
     int res = -1;
     va_list ap;
     va_start(ap, fmt);
-    res = vsnprintf(buffer, SPRINTF_MAX_BUFFER_SIZE, fmt, ap);
+    res = vsnprintf(buffer, (size_t) -1, fmt, ap);
     va_end(ap);
     return res;
 }
 
 __END_DECLS
-/** @} */
\ No newline at end of file
+/** @} */
@@ -0,0 +1,357 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <asm/page.h>
+#include <macondo/kmem_cache.h>
+#include <macondo/page_alloc.h>
+#include <macondo/spin_lock.h>
+
+__BEGIN_DECLS
+
+#define LOG_TAG "KmemCache"
+
+#include <linux_debug.h>
+
+#define WSIZE __SIZEOF_POINTER__
+#define BITS_PER_LONG (sizeof(unsigned long) * 8)
+/* big objects get bigger slabs to keep at least this number of objects */
+#define KMEM_MIN_OBJECTS_PER_SLAB 8
+/* the biggest block page_alloc() hands out */
+#define KMEM_MAX_SLAB_SIZE (PAGE_SIZE << PAGE_MAX_ORDER)
+/* biggest object whose slab still fits into KMEM_MAX_SLAB_SIZE */
+#define KMEM_MAX_OBJECT_SIZE \
+    ((KMEM_MAX_SLAB_SIZE - sizeof(struct kmem_slab) - WSIZE) / KMEM_MIN_OBJECTS_PER_SLAB)
+
+#define CHAR_PTR(ptr) (reinterpret_cast<char*>(ptr))
+#define ALIGN_UP(value, align) (((value) + (align) - 1) & ~((align) - 1))
+
+/*
+ * Slab is slab_size aligned so slab header is found from object address by
+ * masking it. Header is followed by free objects bitmap and objects itself.
+ */
+struct kmem_slab {
+    struct kmem_cache *cache;
+    struct kmem_slab *next;
+    struct kmem_slab *prev;
+    char *objects;
+    size_t in_use;
+    /* bit is set when object is free */
+    unsigned long free_map[];
+};
+
+struct kmem_slab_list {
+    struct kmem_slab *head;
+};
+
+struct kmem_cache {
+    const char *name;
+    kmem_ctor_t ctor;
+    unsigned int flags;
+    size_t object_size;
+    size_t slab_size;
+    size_t objects_per_slab;
+    size_t map_words;
+    size_t objects_offset;
+    /* slabs with some free objects */
+    struct kmem_slab_list partial;
+    /* slabs without free objects */
+    struct kmem_slab_list full;
+    /* slabs without allocated objects */
+    struct kmem_slab_list empty;
+    struct kmem_cache_stats stats;
+    /* protects slab lists, slab bitmaps and statistics, zeroed lock is unlocked */
+    mutable std::spin_lock lock;
+};
+
+static void kmem_list_add(struct kmem_slab_list *list, struct kmem_slab *slab)
+{
+    slab->prev = nullptr;
+    slab->next = list->head;
+
+    if (list->head != nullptr) {
+        list->head->prev = slab;
+    }
+
+    list->head = slab;
+}
+
+static void kmem_list_remove(struct kmem_slab_list *list, struct kmem_slab *slab)
+{
+    if (slab->prev != nullptr) {
+        slab->prev->next = slab->next;
+    }
+    else {
+        list->head = slab->next;
+    }
+
+    if (slab->next != nullptr) {
+        slab->next->prev = slab->prev;
+    }
+}
+
+static inline struct kmem_slab *kmem_obj_to_slab(struct kmem_cache *cache, void *obj)
+{
+    return reinterpret_cast<struct kmem_slab *>(reinterpret_cast<size_t>(obj) & ~(cache->slab_size - 1));
+}
+
+static struct kmem_slab *kmem_slab_create(struct kmem_cache *cache)
+{
+    void *memory = cache->flags & KMEM_CACHE_PAGES
+                   ? page_alloc(page_order(cache->slab_size))
+                   : mem_aligned_alloc(cache->slab_size, cache->slab_size);
+    struct kmem_slab *slab = reinterpret_cast<struct kmem_slab *>(memory);
+
+    if (slab == nullptr) {
+        return nullptr;
+    }
+
+    slab->cache = cache;
+    slab->objects = CHAR_PTR(slab) + cache->objects_offset;
+    slab->in_use = 0;
+
+    for (size_t i = 0; i < cache->map_words; i++) {
+        slab->free_map[i] = ~0UL;
+    }
+
+    /* objects which don't exist are marked as allocated */
+    size_t tail = cache->objects_per_slab % BITS_PER_LONG;
+
+    if (tail != 0) {
+        slab->free_map[cache->map_words - 1] = (1UL << tail) - 1;
+    }
+
+    if (cache->ctor != nullptr) {
+        for (size_t i = 0; i < cache->objects_per_slab; i++) {
+            cache->ctor(slab->objects + i * cache->object_size);
+        }
+    }
+
+    cache->stats.slabs++;
+    cache->stats.slab_allocs++;
+    cache->stats.objects_free += cache->objects_per_slab;
+    return slab;
+}
+
+static void kmem_slab_destroy(struct kmem_cache *cache, struct kmem_slab *slab)
+{
+    cache->stats.slabs--;
+    cache->stats.slab_frees++;
+    cache->stats.objects_free -= cache->objects_per_slab - slab->in_use;
+
+    if (cache->flags & KMEM_CACHE_PAGES) {
+        page_free(slab, page_order(cache->slab_size));
+    }
+    else {
+        mem_free(slab);
+    }
+}
+
+/*
+ * Finds the biggest objects count which fits into slab together with
+ * header and bitmap
+ */
+
+static void kmem_cache_layout(struct kmem_cache *cache, size_t align)
+{
+    size_t slab_size = PAGE_SIZE;
+
+    while (slab_size < sizeof(struct kmem_slab) + WSIZE + KMEM_MIN_OBJECTS_PER_SLAB * cache->object_size) {
+        slab_size <<= 1;
+    }
+
+    size_t count = (slab_size - sizeof(struct kmem_slab)) / cache->object_size;
+    size_t words = 0;
+    size_t offset = 0;
+
+    for (; count > 0; count--) {
+        words = (count + BITS_PER_LONG - 1) / BITS_PER_LONG;
+        offset = ALIGN_UP(sizeof(struct kmem_slab) + words * sizeof(unsigned long), align);
+
+        if (offset + count * cache->object_size <= slab_size) {
+            break;
+        }
+    }
+
+    cache->slab_size = slab_size;
+    cache->objects_per_slab = count;
+    cache->map_words = words;
+    cache->objects_offset = offset;
+}
+
+struct kmem_cache *kmem_cache_create(const char *name, size_t size, size_t align,
+                                     unsigned int flags, kmem_ctor_t ctor)
+{
+    if (align == 0) {
+        align = WSIZE;
+    }
+
+    /* size is bounded before it's aligned, so neither layout nor alignment overflows */
+    if (size == 0 || (align & (align - 1)) != 0 || align > PAGE_SIZE
+        || size > KMEM_MAX_OBJECT_SIZE || ALIGN_UP(size, align) > KMEM_MAX_OBJECT_SIZE) {
+        ALOGE("%s(): Invalid object size %lu or alignment %lu\n", __func__, size, align);
+        return nullptr;
+    }
+
+    struct kmem_cache *cache = reinterpret_cast<struct kmem_cache *>(mem_calloc(1, sizeof(struct kmem_cache)));
+
+    if (cache == nullptr) {
+        return nullptr;
+    }
+
+    cache->name = name;
+    cache->ctor = ctor;
+    cache->flags = flags;
+    cache->object_size = ALIGN_UP(size, align);
+    kmem_cache_layout(cache, align);
+    cache->stats.object_size = cache->object_size;
+    cache->stats.slab_size = cache->slab_size;
+    cache->stats.objects_per_slab = cache->objects_per_slab;
+    return cache;
+}
+
+void kmem_cache_destroy(struct kmem_cache *cache)
+{
+    if (cache == nullptr) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::spin_lock> guard(cache->lock);
+
+        if (cache->stats.objects_in_use != 0) {
+            ALOGE("%s(): cache %s still has %lu objects in use\n", __func__,
+                  cache->name, cache->stats.objects_in_use);
+        }
+
+        struct kmem_slab_list *lists[] = {&cache->partial, &cache->full, &cache->empty};
+
+        for (struct kmem_slab_list *list: lists) {
+            while (list->head != nullptr) {
+                struct kmem_slab *slab = list->head;
+                kmem_list_remove(list, slab);
+                kmem_slab_destroy(cache, slab);
+            }
+        }
+    }
+
+    mem_free(cache);
+}
+
+void *kmem_cache_alloc(struct kmem_cache *cache)
+{
+    std::lock_guard<std::spin_lock> guard(cache->lock);
+    struct kmem_slab *slab = cache->partial.head;
+
+    if (slab == nullptr) {
+        slab = cache->empty.head;
+
+        if (slab != nullptr) {
+            kmem_list_remove(&cache->empty, slab);
+        }
+        else if ((slab = kmem_slab_create(cache)) == nullptr) {
+            return nullptr;
+        }
+
+        kmem_list_add(&cache->partial, slab);
+    }
+
+    size_t word = 0;
+
+    while (slab->free_map[word] == 0) {
+        word++;
+    }
+
+    size_t bit = ffsl((long) slab->free_map[word]) - 1;
+    slab->free_map[word] &= ~(1UL << bit);
+
+    if (++slab->in_use == cache->objects_per_slab) {
+        kmem_list_remove(&cache->partial, slab);
+        kmem_list_add(&cache->full, slab);
+    }
+
+    cache->stats.allocs++;
+    cache->stats.objects_in_use++;
+    cache->stats.objects_free--;
+    return slab->objects + (word * BITS_PER_LONG + bit) * cache->object_size;
+}
+
+void kmem_cache_free(struct kmem_cache *cache, void *obj)
+{
+    if (obj == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::spin_lock> guard(cache->lock);
+    struct kmem_slab *slab = kmem_obj_to_slab(cache, obj);
+    size_t offset = CHAR_PTR(obj) - slab->objects;
+    size_t index = offset / cache->object_size;
+
+    if (slab->cache != cache || offset % cache->object_size != 0 || index >= cache->objects_per_slab
+        || (slab->free_map[index / BITS_PER_LONG] & (1UL << (index % BITS_PER_LONG))) != 0) {
+        ALOGE("%s(): Invalid pointer %p for cache %s\n", __func__, obj, cache->name);
+        return;
+    }
+
+    slab->free_map[index / BITS_PER_LONG] |= 1UL << (index % BITS_PER_LONG);
+
+    if (slab->in_use-- == cache->objects_per_slab) {
+        kmem_list_remove(&cache->full, slab);
+        kmem_list_add(&cache->partial, slab);
+    }
+
+    if (slab->in_use == 0) {
+        kmem_list_remove(&cache->partial, slab);
+        kmem_list_add(&cache->empty, slab);
+    }
+
+    cache->stats.frees++;
+    cache->stats.objects_in_use--;
+    cache->stats.objects_free++;
+}
+
+size_t kmem_cache_shrink(struct kmem_cache *cache)
+{
+    std::lock_guard<std::spin_lock> guard(cache->lock);
+    size_t count = 0;
+
+    while (cache->empty.head != nullptr) {
+        struct kmem_slab *slab = cache->empty.head;
+        kmem_list_remove(&cache->empty, slab);
+        kmem_slab_destroy(cache, slab);
+        count++;
+    }
+
+    return count;
+}
+
+void kmem_cache_get_stats(const struct kmem_cache *cache, struct kmem_cache_stats *stats)
+{
+    std::lock_guard<std::spin_lock> guard(cache->lock);
+    *stats = cache->stats;
+}
+
+__END_DECLS
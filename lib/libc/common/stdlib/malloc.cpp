@@ -24,7 +24,10 @@
 
 #include <stddef.h>
 #include <errno.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <macondo/spin_lock.h>
 
 __BEGIN_DECLS
 
@@ -41,17 +44,19 @@ __BEGIN_DECLS
 /* free block header size */
 #define FOOTER_SIZE HEADER_SIZE
 /* size of header and footer e.g. overhead */
-#define OVERHEAD_SIZE HEADER_SIZE + FOOTER_SIZE
-
-static void *sMemHeapStart = nullptr;
-static void *sMemHeapEnd = nullptr;
+#define OVERHEAD_SIZE (HEADER_SIZE + FOOTER_SIZE)
+/* free block keeps next and prev free list links in its payload */
+#define MIN_BLOCK_SIZE (2 * WSIZE)
 
 #define SIZE_T_PTR(ptr) (reinterpret_cast<size_t*>(ptr))
 #define CHAR_PTR(ptr) (reinterpret_cast<char*>(ptr))
+#define VOID_PTR_PTR(ptr) (reinterpret_cast<void**>(ptr))
 #define USER_PTR(ptr) (CHAR_PTR(ptr) + HEADER_SIZE)
 
 #define ALLOCATED   1 /* block is allocated */
 #define UNALLOCATED 0 /* block is free */
+#define CACHED      2 /* allocated block is parked in per-CPU magazine */
+#define FLAGS_MASK  (ALLOCATED | CACHED)
 
 /*
  * Put size and allocation state to implicit header
@@ -73,7 +78,7 @@ static inline void *mem_header(void *ptr)
 
 static inline size_t mem_block_size(void *p)
 {
-    return (*SIZE_T_PTR(mem_header(p)) & ~0x01);
+    return (*SIZE_T_PTR(mem_header(p)) & ~FLAGS_MASK);
 }
 
 static inline size_t mem_block_size_with_overhead(void *ptr)
@@ -81,9 +86,13 @@ static inline size_t mem_block_size_with_overhead(void *ptr)
     return mem_block_size(ptr) + OVERHEAD_SIZE;
 }
 
+/*
+ * Footer is placed right after payload so it never overlaps user data
+ */
+
 static inline void *mem_footer(void *ptr)
 {
-    return CHAR_PTR(ptr) + mem_block_size(ptr) - FOOTER_SIZE;
+    return CHAR_PTR(ptr) + mem_block_size(ptr);
 }
 
 static inline void mem_put_to_header(void *ptr, size_t size,
@@ -110,276 +119,1486 @@ static inline void *mem_init_block(void *ptr, size_t size,
 
 static inline bool mem_block_allocated(void *p)
 {
-    return (*SIZE_T_PTR(mem_header(p)) & 0x01) == ALLOCATED;
+    return (*SIZE_T_PTR(mem_header(p)) & ALLOCATED) == ALLOCATED;
+}
+
+static inline bool mem_block_cached(void *p)
+{
+    return (*SIZE_T_PTR(mem_header(p)) & CACHED) == CACHED;
 }
 
 static inline void *mem_next_block(void *ptr)
 {
-    return CHAR_PTR(mem_header(ptr)) + mem_block_size(ptr) + OVERHEAD_SIZE;
+    return CHAR_PTR(ptr) + mem_block_size(ptr) + OVERHEAD_SIZE;
 }
 
 static inline void *mem_prev_block(void *ptr)
 {
-    char *header = CHAR_PTR(mem_header(ptr));
-    //char* prev_blk_footer = CHAR_PTR(header) - FOOTER_SIZE;
-    return (header - mem_block_size(header));
+    /* footer of previous block lays right before our header */
+    size_t prev_size = mem_block_size(mem_header(ptr));
+    return CHAR_PTR(ptr) - OVERHEAD_SIZE - prev_size;
 }
 
-static void *mem_place(void *block, size_t size)
-{
-    size_t cur_size = mem_block_size(block);
-    size -= OVERHEAD_SIZE;
+/*
+ * Rounds requested size up to word and makes it big enough to keep
+ * free list links once the block is released
+ */
 
-    if (size < cur_size) {
-        size_t new_size = cur_size - size - HEADER_SIZE;
-        mem_put_to_footer(block, new_size, UNALLOCATED);
-        mem_put_to_header(block, size, ALLOCATED);
-        mem_put_to_footer(block, size, ALLOCATED);
-        mem_put_to_header(mem_next_block(block), new_size, UNALLOCATED);
-        return block;
+static inline size_t mem_adjust_size(size_t size)
+{
+    if (size < MIN_BLOCK_SIZE) {
+        return MIN_BLOCK_SIZE;
     }
-    else if (size == cur_size) {
-        mem_put_to_header(block, size, ALLOCATED);
-        mem_put_to_footer(block, size, ALLOCATED);
-        return block;
+
+    return WSIZE * ((size + WSIZE - 1) / WSIZE);
+}
+
+static inline void *&mem_free_next(void *ptr)
+{
+    return VOID_PTR_PTR(ptr)[0];
+}
+
+static inline void *&mem_free_prev(void *ptr)
+{
+    return VOID_PTR_PTR(ptr)[1];
+}
+
+#ifdef MALLOC_TLSF
+
+/*
+ * Two-level segregated fit index. First level splits sizes by power of two,
+ * second level splits every power of two range into SL_INDEX_COUNT linear
+ * lists. Both levels are tracked with bitmaps so insert, remove and search
+ * are O(1) and don't depend on heap population.
+ */
+#define SL_INDEX_COUNT_LOG2 4
+#define SL_INDEX_COUNT (1 << SL_INDEX_COUNT_LOG2)
+#define ALIGN_SIZE_LOG2 3
+/* sizes below SMALL_BLOCK_SIZE are mapped linearly to first list */
+#define FL_INDEX_SHIFT (SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2)
+#define SMALL_BLOCK_SIZE (1UL << FL_INDEX_SHIFT)
+/* largest supported block is 64 GiB */
+#define FL_INDEX_MAX 36
+#define FL_INDEX_COUNT (FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define MAX_BLOCK_SIZE (1UL << FL_INDEX_MAX)
+
+struct mem_free_index {
+    void *lists[FL_INDEX_COUNT][SL_INDEX_COUNT];
+    /* bit fl is set when any of lists[fl] is not empty */
+    unsigned long fl_map;
+    /* bit sl of sl_map[fl] is set when lists[fl][sl] is not empty */
+    unsigned int sl_map[FL_INDEX_COUNT];
+};
+
+static inline void mem_mapping_insert(size_t size, int *fl, int *sl)
+{
+    if (size < SMALL_BLOCK_SIZE) {
+        *fl = 0;
+        *sl = (int) (size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
     }
     else {
-        ALOGD("%s(): cur_size is %lu size is %lu. Ignore request\n",
-              __func__, cur_size, size);
+        int f = flsl((long) size) - 1;
+        *sl = (int) (size >> (f - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+        *fl = f - (FL_INDEX_SHIFT - 1);
+
+        if (*fl >= FL_INDEX_COUNT) {
+            *fl = FL_INDEX_COUNT - 1;
+            *sl = SL_INDEX_COUNT - 1;
+        }
     }
+}
 
-    return nullptr;
+/*
+ * Rounds size up to the next list boundary so that any block found in the
+ * resulting list is big enough. This is what makes the search O(1)
+ */
+
+static inline void mem_mapping_search(size_t size, int *fl, int *sl)
+{
+    if (size >= SMALL_BLOCK_SIZE) {
+        size += (1UL << (flsl((long) size) - 1 - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+
+    mem_mapping_insert(size, fl, sl);
 }
 
-static void *mem_find_first_fit(size_t size)
+static void mem_index_reset(struct mem_free_index *index)
 {
-    for (void *cur_blk = sMemHeapStart; cur_blk < sMemHeapEnd; cur_blk = mem_next_block(cur_blk)) {
-        if (!mem_block_allocated(cur_blk) && mem_block_size(cur_blk) >= size) {
-            return cur_blk;
+    for (int i = 0; i < FL_INDEX_COUNT; i++) {
+        for (int j = 0; j < SL_INDEX_COUNT; j++) {
+            index->lists[i][j] = nullptr;
         }
+
+        index->sl_map[i] = 0;
     }
 
-    return nullptr;
+    index->fl_map = 0;
 }
 
-static void *mem_merge(void *ptr)
+static void mem_index_insert(struct mem_free_index *index, void *ptr)
 {
-    bool next_allocated = mem_block_allocated(mem_next_block(ptr));
-    bool prev_allocated = mem_block_allocated(mem_prev_block(ptr));
+    int fl = 0;
+    int sl = 0;
     size_t size = mem_block_size(ptr);
+    mem_mapping_insert(size, &fl, &sl);
+    void *head = index->lists[fl][sl];
 
-    if (prev_allocated && next_allocated) {
-        /* Do nothing */
-    }
+    mem_free_next(ptr) = head;
+    mem_free_prev(ptr) = nullptr;
 
-    else if (prev_allocated && !next_allocated) {
-        size += mem_block_size(mem_next_block(ptr)) + FOOTER_SIZE;
-        void *footer = mem_footer(ptr);
-        mem_put_to_header(ptr, size, UNALLOCATED);
-        mem_pack(footer, size, UNALLOCATED);
+    if (head != nullptr) {
+        mem_free_prev(head) = ptr;
     }
 
-    else if (!prev_allocated && next_allocated) {
-        void *prev = mem_prev_block(ptr);
-        void *footer = mem_footer(ptr);
-        size += mem_block_size(prev) + FOOTER_SIZE;
-        mem_put_to_header(prev, size, UNALLOCATED);
-        mem_pack(footer, size, UNALLOCATED);
+    index->lists[fl][sl] = ptr;
+    index->fl_map |= 1UL << fl;
+    index->sl_map[fl] |= 1U << sl;
+}
+
+static void mem_index_remove(struct mem_free_index *index, void *ptr)
+{
+    int fl = 0;
+    int sl = 0;
+    size_t size = mem_block_size(ptr);
+    mem_mapping_insert(size, &fl, &sl);
+    void *next = mem_free_next(ptr);
+    void *prev = mem_free_prev(ptr);
+
+    if (prev != nullptr) {
+        mem_free_next(prev) = next;
     }
+    else {
+        index->lists[fl][sl] = next;
 
-    else if (!prev_allocated && !next_allocated) {
-        void *header = mem_header(mem_prev_block(ptr));
-        void *footer = mem_footer(mem_next_block(ptr));
-        size += mem_block_size(mem_prev_block(ptr)) +
-            mem_block_size(mem_next_block(ptr)) + OVERHEAD_SIZE;
-        mem_pack(header, size, UNALLOCATED);
-        mem_pack(footer, size, UNALLOCATED);
+        if (next == nullptr) {
+            index->sl_map[fl] &= ~(1U << sl);
+
+            if (index->sl_map[fl] == 0) {
+                index->fl_map &= ~(1UL << fl);
+            }
+        }
     }
 
-    return ptr;
+    if (next != nullptr) {
+        mem_free_prev(next) = prev;
+    }
 }
 
-/**
- * @brief malloc - allocates unused space for an object whose size in bytes is
- *                 specified by size and whose value is unspecified.
- * @param size   - desired size of block for allocation
- * @return         Upon successful completion with size not equal to 0, malloc()
- *                 shall return a pointer to the allocated space. If size is 0,
- *                 either:
- *
- * A null pointer shall be returned and errno set to 0
- * Otherwise, it shall return a null pointer and set errno to ENOMEM
- */
-void *mem_malloc(size_t size)
+static void *mem_index_find_fit(struct mem_free_index *index, size_t size)
 {
-    size_t asize = 0;
-    void *bp = nullptr;
+    int fl = 0;
+    int sl = 0;
 
-    if (size < WSIZE) {
-        asize = WSIZE + OVERHEAD_SIZE;
-    }
-    else {
-        asize = WSIZE * ((size + OVERHEAD_SIZE + WSIZE - 1) / WSIZE);
+    if (size >= MAX_BLOCK_SIZE) {
+        return nullptr;
     }
 
-    bp = mem_find_first_fit(asize);
+    mem_mapping_search(size, &fl, &sl);
 
-    if (bp != nullptr) {
-        bp = mem_place(bp, asize);
+    unsigned int sl_map = index->sl_map[fl] & (~0U << sl);
+
+    if (sl_map == 0) {
+        unsigned long fl_map = fl + 1 < FL_INDEX_COUNT ? index->fl_map & (~0UL << (fl + 1)) : 0;
+
+        if (fl_map == 0) {
+            /*
+             * Rounding may skip the list which has a fitting block, e.g. when
+             * almost whole heap is requested. Peek its head, still O(1)
+             */
+            mem_mapping_insert(size, &fl, &sl);
+            void *blk = index->lists[fl][sl];
+            return blk != nullptr && mem_block_size(blk) >= size ? blk : nullptr;
+        }
+
+        fl = ffsl((long) fl_map) - 1;
+        sl_map = index->sl_map[fl];
     }
 
-    return bp;
+    sl = ffs((int) sl_map) - 1;
+    return index->lists[fl][sl];
 }
 
-/**
- * @brief free - deallocate previously allocated via alloc() memory
- * @param ptr  - pointer to previously allocated block
- *
- * if the argument does not match a pointer earlier returned by a function
- * in POSIX.1-2017 that allocates memory as if by malloc(), or if the space has
- * been deallocated by a call to free() or realloc(), the behavior is undefined.
- *
- * Any use of a pointer that refers to freed space results in undefined behavior.
- */
-void mem_free(void *ptr)
+/* Largest block lives in the highest non empty list, lists aren't sorted */
+
+static size_t mem_index_largest(struct mem_free_index *index)
 {
-    if (ptr != nullptr && mem_block_allocated(ptr)) {
-        size_t size = mem_block_size(ptr);
-        mem_init_block(ptr, size, UNALLOCATED);
-        mem_merge(ptr);
+    size_t largest = 0;
+
+    if (index->fl_map == 0) {
+        return 0;
     }
-    else {
-        ALOGE("%s(): Invalid pointer\n", __func__);
+
+    int fl = flsl((long) index->fl_map) - 1;
+    int sl = fls((int) index->sl_map[fl]) - 1;
+
+    for (void *cur_blk = index->lists[fl][sl]; cur_blk != nullptr; cur_blk = mem_free_next(cur_blk)) {
+        if (mem_block_size(cur_blk) > largest) {
+            largest = mem_block_size(cur_blk);
+        }
     }
+
+    return largest;
 }
 
-/**
- * @brief realloc - deallocates the old object pointed to by ptr and return
- *                  a pointer to a new object that has the size specified by size.
- * @param ptr     - pointer to previously allocated via malloc() block
- * @param size    - new desired size of newly allocated block
- * @return        - newly allocated block with the same content or NULL
- *                  In case of error errno is set to ENOMEM
- *
- * The contents of the new object is the same as that of the old object prior
- * to deallocation, up to the lesser of the new and old sizes.
- * Any bytes in the new object beyond the size of the old object have
- * indeterminate values. If the size of the space requested is zero, then
- * returns the same pointer
+#else /* MALLOC_TLSF */
+
+/*
+ * Free blocks are indexed by segregated lists. Class k holds blocks whose
+ * payload size lies in [2^(k + MIN_CLASS_SHIFT), 2^(k + MIN_CLASS_SHIFT + 1)),
+ * the last class holds everything bigger.
  */
-void *mem_realloc(void *ptr, size_t size)
+#define MIN_CLASS_SHIFT 4
+#define SIZE_CLASSES_COUNT 32
+
+struct mem_free_index {
+    void *lists[SIZE_CLASSES_COUNT];
+    /* bit k is set when lists[k] is not empty */
+    unsigned long map;
+};
+
+static inline int mem_size_class(size_t size)
 {
-    if (size == 0 || ptr == nullptr) {
-        return ptr;
+    int cls = flsl((long) size) - 1 - MIN_CLASS_SHIFT;
+    return cls < SIZE_CLASSES_COUNT ? cls : SIZE_CLASSES_COUNT - 1;
+}
+
+static void mem_index_reset(struct mem_free_index *index)
+{
+    for (int i = 0; i < SIZE_CLASSES_COUNT; i++) {
+        index->lists[i] = nullptr;
     }
 
-    if (ptr != nullptr && mem_block_allocated(ptr)) {
-        size_t asize = WSIZE * ((size + OVERHEAD_SIZE + WSIZE - 1) / WSIZE);
-        size_t cur_size = mem_block_size(ptr);
+    index->map = 0;
+}
+
+static void mem_index_insert(struct mem_free_index *index, void *ptr)
+{
+    size_t size = mem_block_size(ptr);
+    int cls = mem_size_class(size);
+    void *head = index->lists[cls];
 
-        if (asize > cur_size) {
-            void *blk = mem_find_first_fit(asize);
+    mem_free_next(ptr) = head;
+    mem_free_prev(ptr) = nullptr;
 
-            if (blk != nullptr) {
-                mem_place(blk, asize);
-                memmove(blk, ptr, mem_block_size(ptr));
-                mem_free(ptr);
-                return blk;
-            }
-        }
-        else if (asize < cur_size) {
-            void *p = mem_place(ptr, asize);
-            mem_merge(mem_next_block(ptr));
-            return p;
-        }
+    if (head != nullptr) {
+        mem_free_prev(head) = ptr;
+    }
+
+    index->lists[cls] = ptr;
+    index->map |= 1UL << cls;
+}
+
+static void mem_index_remove(struct mem_free_index *index, void *ptr)
+{
+    size_t size = mem_block_size(ptr);
+    int cls = mem_size_class(size);
+    void *next = mem_free_next(ptr);
+    void *prev = mem_free_prev(ptr);
+
+    if (prev != nullptr) {
+        mem_free_next(prev) = next;
     }
     else {
-        ALOGD("%s(): Invalid pointer\n", __func__);
-        return nullptr;
+        index->lists[cls] = next;
+
+        if (next == nullptr) {
+            index->map &= ~(1UL << cls);
+        }
     }
 
-    return ptr;
+    if (next != nullptr) {
+        mem_free_prev(next) = prev;
+    }
 }
 
-/**
- * @brief calloc - allocates unused space for an array of count elements each of
- *                 whose size in bytes is size. Each byte of allocated memory is
- *                 set to 0
- * @param count  - count of an array elements
- * @param size   - size of one element of the array
- * @return       - allocated memory or NULL pointer. In case of error
- *                 errno is set to ENOMEM
+/*
+ * Segregated fit: any block of a bigger class fits, so take the head of the
+ * first non empty one. Blocks of own class may be smaller than requested,
+ * only the head is tried before that, the rest of the list is scanned when
+ * there is nothing bigger
  */
-void *mem_calloc(size_t count, size_t size)
+
+static void *mem_index_find_fit(struct mem_free_index *index, size_t size)
 {
-    void *p = mem_malloc(count * size);
+    int cls = mem_size_class(size);
+    void *head = index->lists[cls];
 
-    if (p != nullptr) {
-        memset(p, 0, size);
+    if (head != nullptr && mem_block_size(head) >= size) {
+        return head;
     }
 
-    return p;
+    if (cls + 1 < SIZE_CLASSES_COUNT) {
+        unsigned long map = index->map & (~0UL << (cls + 1));
+
+        if (map != 0) {
+            return index->lists[ffsl((long) map) - 1];
+        }
+    }
+
+    for (void *cur_blk = index->lists[cls]; cur_blk != nullptr; cur_blk = mem_free_next(cur_blk)) {
+        if (mem_block_size(cur_blk) >= size) {
+            return cur_blk;
+        }
+    }
+
+    return nullptr;
 }
 
-int mem_init(void *start, size_t sizeInBytes)
+/* Largest block lives in the highest non empty class, classes aren't sorted */
+
+static size_t mem_index_largest(struct mem_free_index *index)
 {
-    if (start != nullptr && sizeInBytes > 0) {
-        /* first and last blocks must be always allocated */
-        sMemHeapStart = start;
-        mem_init_block(USER_PTR(sMemHeapStart), WSIZE, ALLOCATED);
-        sMemHeapEnd = CHAR_PTR(start) + sizeInBytes - (OVERHEAD_SIZE + WSIZE);
-        mem_init_block(USER_PTR(sMemHeapEnd), WSIZE, ALLOCATED);
-        void *heap = mem_next_block(USER_PTR(sMemHeapStart));
-        /* take in account reserved blocks and their overheads including heap
-         * sMemHeapStart has overhead 16 bytes and size 8 bytes
-         * the same about sMemHeapEnd
-         */
-        size_t reserved_size = (OVERHEAD_SIZE + WSIZE) * 2;
-        size_t heap_size = sizeInBytes - reserved_size;
-        mem_init_block(heap, heap_size, UNALLOCATED);
+    size_t largest = 0;
+
+    if (index->map == 0) {
         return 0;
     }
 
-    return EINVAL;
+    int cls = flsl((long) index->map) - 1;
+
+    for (void *cur_blk = index->lists[cls]; cur_blk != nullptr; cur_blk = mem_free_next(cur_blk)) {
+        if (mem_block_size(cur_blk) > largest) {
+            largest = mem_block_size(cur_blk);
+        }
+    }
+
+    return largest;
 }
 
-void mem_dump()
+#endif /* MALLOC_TLSF */
+
+/*
+ * Arena is an independent heap with its own lock, free lists and statistics.
+ * mem_* functions work on default arena, other arenas keep this header in
+ * front of the region they manage.
+ */
+struct mem_arena {
+    /* prologue and epilogue blocks, they are always allocated */
+    void *heap_start;
+    void *heap_end;
+    /* protects heap blocks, free lists and statistics */
+    std::spin_lock lock;
+    /* bytes_in_use and largest_free_block are derived when stats are requested */
+    struct mem_stats stats;
+    struct mem_free_index index;
+    /* bytes from here up to heap_end were never written and are zero */
+    char *zeroed_from;
+};
+
+static struct mem_arena sMemDefaultArena;
+
+static inline int mem_stats_class(size_t size)
 {
-    void *cur_blk = nullptr;
-    size_t total_memory = 0;
-    size_t total_with_overhead = 0;
-    size_t total_blocks = 0;
+    int cls = flsl((long) size) - 5;
+    return cls < MEM_STATS_CLASSES ? cls : MEM_STATS_CLASSES - 1;
+}
 
-    ALOGD(
-        "*************************MEMORY DUMP*************************");
+/* Free block accounting, called whenever block enters or leaves free lists */
 
-    if (sMemHeapStart != nullptr && sMemHeapEnd != nullptr) {
-        for (cur_blk = USER_PTR(sMemHeapStart); cur_blk <= USER_PTR(sMemHeapEnd); total_blocks++) {
-            size_t blk_size = mem_block_size(cur_blk);
-            size_t blk_size_with_overhead = mem_block_size_with_overhead(cur_blk);
-            total_memory += blk_size;
-            total_with_overhead += blk_size_with_overhead;
-            const char *format = cur_blk == sMemHeapStart || cur_blk == sMemHeapEnd
-                                 ? "service block address %p size %12lu \t size with overhead %8lu state %s"
-                                 : "block address         %p size %12lu \t size with overhead %8lu state %s";
+static inline void mem_stats_add_free(struct mem_arena *arena, size_t size)
+{
+    arena->stats.bytes_free += size;
+    arena->stats.free_blocks++;
+    arena->stats.free_blocks_by_class[mem_stats_class(size)]++;
+}
 
-            ALOGD(format, cur_blk,
-                  blk_size, blk_size_with_overhead,
-                  mem_block_allocated(cur_blk) == ALLOCATED ? "allocated" : "free");
-            cur_blk = mem_next_block(cur_blk);
+static inline void mem_stats_remove_free(struct mem_arena *arena, size_t size)
+{
+    arena->stats.bytes_free -= size;
+    arena->stats.free_blocks--;
+    arena->stats.free_blocks_by_class[mem_stats_class(size)]--;
+}
+
+static inline size_t mem_stats_in_use(struct mem_arena *arena)
+{
+    return arena->stats.heap_size - arena->stats.bytes_free - arena->stats.free_blocks * OVERHEAD_SIZE;
+}
+
+static void *mem_stats_count_alloc(struct mem_arena *arena, void *ptr)
+{
+    if (ptr != nullptr) {
+        size_t in_use = mem_stats_in_use(arena);
+        arena->stats.allocs++;
+
+        if (in_use > arena->stats.peak_bytes_in_use) {
+            arena->stats.peak_bytes_in_use = in_use;
         }
     }
     else {
-        ALOGD("Not initialized");
+        arena->stats.failures++;
     }
 
-    ALOGD(
-        "**********************END OF MEMORY DUMP**********************");
+    return ptr;
+}
 
-    ALOGD("total memory               %12lu bytes", total_memory);
-    ALOGD("total memory with overhead %12lu bytes", total_with_overhead);
-    ALOGD("total total_blocks count   %12lu", total_blocks);
+static void mem_free_list_insert(struct mem_arena *arena, void *ptr)
+{
+    mem_stats_add_free(arena, mem_block_size(ptr));
+    mem_index_insert(&arena->index, ptr);
 }
 
-__END_DECLS
+static void mem_free_list_remove(struct mem_arena *arena, void *ptr)
+{
+    mem_stats_remove_free(arena, mem_block_size(ptr));
+    mem_index_remove(&arena->index, ptr);
+}
+
+static inline void *mem_find_fit(struct mem_arena *arena, size_t size)
+{
+    return mem_index_find_fit(&arena->index, size);
+}
+
+/* Pointer of another arena or not a heap pointer at all is refused */
+
+static inline bool mem_arena_owns(struct mem_arena *arena, void *ptr)
+{
+    return ptr > arena->heap_start && ptr < arena->heap_end;
+}
+
+
+/*
+ * Heap below end may have been written, e.g. by block ptr and by header and
+ * free list links of the block after it
+ */
+
+static inline void mem_touch(struct mem_arena *arena, void *end)
+{
+    if (CHAR_PTR(end) > arena->zeroed_from) {
+        arena->zeroed_from = CHAR_PTR(end);
+    }
+}
+
+static inline void mem_touch_block(struct mem_arena *arena, void *ptr)
+{
+    mem_touch(arena, CHAR_PTR(mem_next_block(ptr)) + MIN_BLOCK_SIZE);
+}
+
+/*
+ * Cuts the tail of block ptr off if it's big enough to be a standalone block.
+ * Returns the tail or nullptr; the tail is marked free but not indexed
+ */
+
+static void *mem_split(void *ptr, size_t size, size_t flags)
+{
+    size_t cur_size = mem_block_size(ptr);
+
+    if (cur_size >= size + OVERHEAD_SIZE + MIN_BLOCK_SIZE) {
+        mem_init_block(ptr, size, flags);
+        void *rest = mem_next_block(ptr);
+        mem_init_block(rest, cur_size - size - OVERHEAD_SIZE, UNALLOCATED);
+        return rest;
+    }
+
+    mem_init_block(ptr, cur_size, flags);
+    return nullptr;
+}
+
+static void *mem_place(struct mem_arena *arena, void *block, size_t size)
+{
+    mem_free_list_remove(arena, block);
+    void *rest = mem_split(block, size, ALLOCATED);
+
+    if (rest != nullptr) {
+        mem_free_list_insert(arena, rest);
+    }
+
+    mem_touch_block(arena, block);
+    return block;
+}
 
+/*
+ * Coalesces free block ptr with free neighbours, neighbours are unlinked from
+ * free lists. Returns resulting block which is not indexed yet
+ */
+
+static void *mem_merge(struct mem_arena *arena, void *ptr)
+{
+    void *next = mem_next_block(ptr);
+    void *prev = mem_prev_block(ptr);
+    bool next_allocated = mem_block_allocated(next);
+    bool prev_allocated = mem_block_allocated(prev);
+    size_t size = mem_block_size(ptr);
+
+    if (prev_allocated && next_allocated) {
+        /* Do nothing */
+    }
+
+    else if (prev_allocated && !next_allocated) {
+        mem_free_list_remove(arena, next);
+        size += mem_block_size(next) + OVERHEAD_SIZE;
+        mem_init_block(ptr, size, UNALLOCATED);
+    }
+
+    else if (!prev_allocated && next_allocated) {
+        mem_free_list_remove(arena, prev);
+        size += mem_block_size(prev) + OVERHEAD_SIZE;
+        ptr = mem_init_block(prev, size, UNALLOCATED);
+    }
+
+    else if (!prev_allocated && !next_allocated) {
+        mem_free_list_remove(arena, prev);
+        mem_free_list_remove(arena, next);
+        size += mem_block_size(prev) + mem_block_size(next) + 2 * OVERHEAD_SIZE;
+        ptr = mem_init_block(prev, size, UNALLOCATED);
+    }
+
+    return ptr;
+}
+
+static void *mem_heap_malloc(struct mem_arena *arena, size_t size)
+{
+    size_t asize = mem_adjust_size(size);
+    void *bp = mem_find_fit(arena, asize);
+
+    if (bp != nullptr) {
+        bp = mem_place(arena, bp, asize);
+    }
+
+    return bp;
+}
+
+static bool mem_heap_free(struct mem_arena *arena, void *ptr)
+{
+    if (mem_arena_owns(arena, ptr) && mem_block_allocated(ptr)) {
+        size_t size = mem_block_size(ptr);
+        mem_init_block(ptr, size, UNALLOCATED);
+        mem_free_list_insert(arena, mem_merge(arena, ptr));
+        return true;
+    }
+
+    ALOGE("%s(): Invalid pointer\n", __func__);
+    return false;
+}
+
+/*
+ * Allocates block whose payload is aligned to alignment. Fit is taken big
+ * enough to cut leading slack off as standalone free block, so only the
+ * requested size stays allocated
+ */
+
+static void *mem_heap_aligned_alloc(struct mem_arena *arena, size_t alignment, size_t size)
+{
+    size_t asize = mem_adjust_size(size);
+
+    if (alignment <= WSIZE) {
+        return mem_heap_malloc(arena, asize);
+    }
+
+    size_t min_lead = OVERHEAD_SIZE + MIN_BLOCK_SIZE;
+
+    if (asize + alignment + min_lead < asize) {
+        return nullptr;
+    }
+
+    void *blk = mem_find_fit(arena, asize + alignment + min_lead);
+
+    if (blk == nullptr) {
+        return nullptr;
+    }
+
+    size_t addr = reinterpret_cast<size_t>(blk);
+    size_t aligned = (addr + alignment - 1) & ~(alignment - 1);
+
+    while (aligned != addr && aligned - addr < min_lead) {
+        aligned += alignment;
+    }
+
+    if (aligned == addr) {
+        return mem_place(arena, blk, asize);
+    }
+
+    size_t total = mem_block_size(blk) + OVERHEAD_SIZE;
+    size_t lead = aligned - addr;
+    void *ptr = reinterpret_cast<void *>(aligned);
+
+    mem_free_list_remove(arena, blk);
+    /* block before blk is allocated, otherwise they would be merged */
+    mem_init_block(blk, lead - OVERHEAD_SIZE, UNALLOCATED);
+    mem_free_list_insert(arena, blk);
+    mem_init_block(ptr, total - lead - OVERHEAD_SIZE, ALLOCATED);
+    void *rest = mem_split(ptr, asize, ALLOCATED);
+
+    if (rest != nullptr) {
+        mem_free_list_insert(arena, rest);
+    }
+
+    mem_touch_block(arena, ptr);
+    return ptr;
+}
+
+/*
+ * Tries to grow block ptr up to size without copying by absorbing free next
+ * block. If it isn't enough free previous block is absorbed as well and payload
+ * is moved down. Returns resulting block or nullptr if neighbours are too small
+ */
+
+static void *mem_grow_in_place(struct mem_arena *arena, void *ptr, size_t size)
+{
+    size_t cur_size = mem_block_size(ptr);
+    void *next = mem_next_block(ptr);
+    void *prev = mem_prev_block(ptr);
+    size_t next_size = mem_block_allocated(next) ? 0 : mem_block_size(next) + OVERHEAD_SIZE;
+    size_t prev_size = mem_block_allocated(prev) ? 0 : mem_block_size(prev) + OVERHEAD_SIZE;
+    void *blk = ptr;
+
+    if (cur_size + next_size >= size) {
+        prev_size = 0;
+    }
+    else if (cur_size + next_size + prev_size < size || prev_size == 0) {
+        return nullptr;
+    }
+
+    if (next_size != 0) {
+        mem_free_list_remove(arena, next);
+    }
+
+    if (prev_size != 0) {
+        mem_free_list_remove(arena, prev);
+        blk = prev;
+        memmove(blk, ptr, cur_size);
+    }
+
+    mem_init_block(blk, cur_size + next_size + prev_size, ALLOCATED);
+    void *rest = mem_split(blk, size, ALLOCATED);
+
+    if (rest != nullptr) {
+        mem_free_list_insert(arena, rest);
+    }
+
+    mem_touch_block(arena, blk);
+    return blk;
+}
+
+static void *mem_heap_realloc(struct mem_arena *arena, void *ptr, size_t size)
+{
+    size_t asize = mem_adjust_size(size);
+    size_t cur_size = mem_block_size(ptr);
+
+    if (asize > cur_size) {
+        void *blk = mem_grow_in_place(arena, ptr, asize);
+
+        if (blk != nullptr) {
+            return blk;
+        }
+
+        blk = mem_find_fit(arena, asize);
+
+        if (blk == nullptr) {
+            return nullptr;
+        }
+
+        mem_place(arena, blk, asize);
+        memcpy(blk, ptr, cur_size);
+        mem_heap_free(arena, ptr);
+        return blk;
+    }
+    else if (asize < cur_size) {
+        void *rest = mem_split(ptr, asize, ALLOCATED);
+
+        if (rest != nullptr) {
+            mem_free_list_insert(arena, mem_merge(arena, rest));
+        }
+    }
+
+    return ptr;
+}
+
+static void *mem_arena_malloc(struct mem_arena *arena, size_t size)
+{
+    std::lock_guard<std::spin_lock> guard(arena->lock);
+    return mem_stats_count_alloc(arena, mem_heap_malloc(arena, size));
+}
+
+static void mem_arena_free(struct mem_arena *arena, void *ptr)
+{
+    std::lock_guard<std::spin_lock> guard(arena->lock);
+
+    if (mem_heap_free(arena, ptr)) {
+        arena->stats.frees++;
+    }
+}
+
+static void *mem_arena_realloc(struct mem_arena *arena, void *ptr, size_t size)
+{
+    if (size == 0 || ptr == nullptr) {
+        return ptr;
+    }
+
+    std::lock_guard<std::spin_lock> guard(arena->lock);
+
+    if (!mem_arena_owns(arena, ptr) || !mem_block_allocated(ptr) || mem_block_cached(ptr)) {
+        ALOGD("%s(): Invalid pointer\n", __func__);
+        return nullptr;
+    }
+
+    void *blk = mem_heap_realloc(arena, ptr, size);
+    arena->stats.reallocs++;
+
+    if (blk == nullptr) {
+        arena->stats.failures++;
+    }
+    else if (mem_stats_in_use(arena) > arena->stats.peak_bytes_in_use) {
+        arena->stats.peak_bytes_in_use = mem_stats_in_use(arena);
+    }
+
+    return blk;
+}
+
+static void *mem_arena_aligned_alloc(struct mem_arena *arena, size_t alignment, size_t size)
+{
+    std::lock_guard<std::spin_lock> guard(arena->lock);
+    return mem_stats_count_alloc(arena, mem_heap_aligned_alloc(arena, alignment, size));
+}
+
+/*
+ * Allocates block and clears its first size bytes, the part of block heap has
+ * never written is already zero. Clearing is done without lock
+ */
+
+static void *mem_arena_calloc(struct mem_arena *arena, size_t size)
+{
+    char *zeroed_from;
+    void *ptr;
+
+    {
+        std::lock_guard<std::spin_lock> guard(arena->lock);
+        zeroed_from = arena->zeroed_from;
+        ptr = mem_stats_count_alloc(arena, mem_heap_malloc(arena, size));
+    }
+
+    if (ptr != nullptr && CHAR_PTR(ptr) < zeroed_from) {
+        size_t dirty = static_cast<size_t>(zeroed_from - CHAR_PTR(ptr));
+        memset(ptr, 0, dirty < size ? dirty : size);
+    }
+
+    return ptr;
+}
+
+/*
+ * Lays heap out in [start, start + sizeInBytes), arena lock is held. Region
+ * is zeroed if caller knows it's zero filled
+ */
+
+static int mem_arena_setup(struct mem_arena *arena, void *start, size_t sizeInBytes, bool zeroed)
+{
+    /* prologue, epilogue and at least one minimal free block */
+    size_t reserved_size = (OVERHEAD_SIZE + WSIZE) * 2;
+
+    if (start == nullptr || sizeInBytes < reserved_size + OVERHEAD_SIZE + MIN_BLOCK_SIZE) {
+        return EINVAL;
+    }
+
+    char *begin = CHAR_PTR(start);
+    char *end = begin + sizeInBytes;
+    begin = CHAR_PTR((reinterpret_cast<size_t>(begin) + WSIZE - 1) & ~(size_t) (WSIZE - 1));
+    end = CHAR_PTR(reinterpret_cast<size_t>(end) & ~(size_t) (WSIZE - 1));
+
+    mem_index_reset(&arena->index);
+    memset(&arena->stats, 0, sizeof(arena->stats));
+
+    /* first and last blocks must be always allocated */
+    arena->heap_start = mem_init_block(USER_PTR(begin), WSIZE, ALLOCATED);
+    arena->heap_end = mem_init_block(end - WSIZE - FOOTER_SIZE, WSIZE, ALLOCATED);
+    void *heap = mem_next_block(arena->heap_start);
+    /* take in account reserved blocks and their overheads including heap
+     * heap_start has overhead 16 bytes and size 8 bytes
+     * the same about heap_end
+     */
+    size_t heap_size = (end - begin) - reserved_size - OVERHEAD_SIZE;
+    mem_init_block(heap, heap_size, UNALLOCATED);
+    mem_free_list_insert(arena, heap);
+    arena->stats.heap_size = heap_size + OVERHEAD_SIZE;
+    /* free list links are the only bytes written into the payload */
+    arena->zeroed_from = zeroed ? CHAR_PTR(heap) + MIN_BLOCK_SIZE : CHAR_PTR(arena->heap_end);
+    return 0;
+}
+
+static void mem_arena_get_stats(struct mem_arena *arena, struct mem_stats *stats)
+{
+    std::lock_guard<std::spin_lock> guard(arena->lock);
+    *stats = arena->stats;
+    stats->bytes_in_use = mem_stats_in_use(arena);
+    stats->largest_free_block = mem_index_largest(&arena->index);
+}
+
+static void mem_arena_dump(struct mem_arena *arena)
+{
+    void *cur_blk = nullptr;
+    size_t total_memory = 0;
+    size_t total_with_overhead = 0;
+    size_t total_blocks = 0;
+
+    std::lock_guard<std::spin_lock> guard(arena->lock);
+
+    ALOGD(
+        "*************************MEMORY DUMP*************************");
+
+    if (arena->heap_start != nullptr && arena->heap_end != nullptr) {
+        for (cur_blk = arena->heap_start; cur_blk <= arena->heap_end; total_blocks++) {
+            size_t blk_size = mem_block_size(cur_blk);
+            size_t blk_size_with_overhead = mem_block_size_with_overhead(cur_blk);
+            total_memory += blk_size;
+            total_with_overhead += blk_size_with_overhead;
+            const char *format = cur_blk == arena->heap_start || cur_blk == arena->heap_end
+                                 ? "service block address %p size %12lu \t size with overhead %8lu state %s"
+                                 : "block address         %p size %12lu \t size with overhead %8lu state %s";
+
+            ALOGD(format, cur_blk,
+                  blk_size, blk_size_with_overhead,
+                  mem_block_allocated(cur_blk) == ALLOCATED ? "allocated" : "free");
+            cur_blk = mem_next_block(cur_blk);
+        }
+    }
+    else {
+        ALOGD("Not initialized");
+    }
+
+    ALOGD(
+        "**********************END OF MEMORY DUMP**********************");
+
+    ALOGD("total memory               %12lu bytes", total_memory);
+    ALOGD("total memory with overhead %12lu bytes", total_with_overhead);
+    ALOGD("total total_blocks count   %12lu", total_blocks);
+}
+
+/*
+ * Per-CPU magazine layer (Bonwick & Adams, "Magazines and Vmem").
+ * Every CPU keeps a loaded and a previous magazine of cached blocks for each
+ * small size class, so common malloc/free pair touches only CPU local data.
+ * Full and empty magazines are exchanged with a depot under its own lock and
+ * only when both magazines can't serve the request global heap lock is taken.
+ *
+ * Caller must make sure that it isn't migrated to another CPU while it's inside
+ * mem_malloc/mem_free e.g. preemption is disabled. Magazines serve default
+ * arena only.
+ */
+#define MAG_MAX_CPUS 4
+#define MAG_ROUNDS 15
+#define MAG_CLASS_GRANULE 16
+#define MAG_CLASSES_COUNT 16
+#define MAG_MAX_SIZE (MAG_CLASS_GRANULE * MAG_CLASSES_COUNT)
+#define CACHE_LINE_SIZE 64
+
+struct mem_magazine {
+    struct mem_magazine *next;
+    size_t rounds;
+    void *objs[MAG_ROUNDS];
+};
+
+struct alignas(CACHE_LINE_SIZE) mem_cpu_cache {
+    struct mem_magazine *loaded[MAG_CLASSES_COUNT];
+    struct mem_magazine *previous[MAG_CLASSES_COUNT];
+    /* requests served by magazines, heap counters are under heap lock */
+    size_t allocs;
+    size_t frees;
+};
+
+struct mem_depot {
+    struct mem_magazine *full[MAG_CLASSES_COUNT];
+    struct mem_magazine *empty[MAG_CLASSES_COUNT];
+};
+
+static struct mem_cpu_cache sMemCpuCaches[MAG_MAX_CPUS];
+static struct mem_depot sMemDepot;
+static std::spin_lock sMemDepotLock;
+static unsigned int (*sMemCpuId)(void) = nullptr;
+static unsigned int sMemCpuCount = 0;
+
+static inline int mem_magazine_class(size_t size)
+{
+    return (int) ((size + MAG_CLASS_GRANULE - 1) / MAG_CLASS_GRANULE) - 1;
+}
+
+static inline size_t mem_magazine_class_size(int cls)
+{
+    return (size_t) (cls + 1) * MAG_CLASS_GRANULE;
+}
+
+static inline void mem_magazine_push(struct mem_magazine **list, struct mem_magazine *mag)
+{
+    mag->next = *list;
+    *list = mag;
+}
+
+static inline struct mem_magazine *mem_magazine_pop(struct mem_magazine **list)
+{
+    struct mem_magazine *mag = *list;
+
+    if (mag != nullptr) {
+        *list = mag->next;
+    }
+
+    return mag;
+}
+
+/*
+ * Blocks parked in magazines keep allocated state for heap, header is marked
+ * cached so that freeing them again is caught
+ */
+
+static inline void mem_magazine_put(struct mem_magazine *mag, void *ptr)
+{
+    *SIZE_T_PTR(mem_header(ptr)) |= CACHED;
+    mag->objs[mag->rounds++] = ptr;
+}
+
+static inline void *mem_magazine_take(struct mem_magazine *mag)
+{
+    void *ptr = mag->objs[--mag->rounds];
+    *SIZE_T_PTR(mem_header(ptr)) &= ~CACHED;
+    return ptr;
+}
+
+/* Cache of current CPU or nullptr if cpu_id callback returns id out of range */
+static inline struct mem_cpu_cache *mem_cpu_cache()
+{
+    unsigned int cpu = sMemCpuId();
+
+    return cpu < sMemCpuCount ? &sMemCpuCaches[cpu] : nullptr;
+}
+
+static void *mem_magazine_alloc(int cls)
+{
+    struct mem_cpu_cache *cache = mem_cpu_cache();
+
+    if (cache == nullptr) {
+        return mem_arena_malloc(&sMemDefaultArena, mem_magazine_class_size(cls));
+    }
+
+    struct mem_magazine *loaded = cache->loaded[cls];
+
+    if (loaded != nullptr && loaded->rounds > 0) {
+        cache->allocs++;
+        return mem_magazine_take(loaded);
+    }
+
+    struct mem_magazine *previous = cache->previous[cls];
+
+    if (previous != nullptr && previous->rounds > 0) {
+        cache->loaded[cls] = previous;
+        cache->previous[cls] = loaded;
+        cache->allocs++;
+        return mem_magazine_take(previous);
+    }
+
+    {
+        std::lock_guard<std::spin_lock> guard(sMemDepotLock);
+        struct mem_magazine *full = mem_magazine_pop(&sMemDepot.full[cls]);
+
+        if (full != nullptr) {
+            if (previous != nullptr) {
+                mem_magazine_push(&sMemDepot.empty[cls], previous);
+            }
+
+            cache->previous[cls] = loaded;
+            cache->loaded[cls] = full;
+            cache->allocs++;
+            return mem_magazine_take(full);
+        }
+    }
+
+    return mem_arena_malloc(&sMemDefaultArena, mem_magazine_class_size(cls));
+}
+
+static void mem_magazine_free(void *ptr, int cls)
+{
+    struct mem_cpu_cache *cache = mem_cpu_cache();
+
+    if (cache == nullptr) {
+        mem_arena_free(&sMemDefaultArena, ptr);
+        return;
+    }
+
+    struct mem_magazine *loaded = cache->loaded[cls];
+
+    if (loaded != nullptr && loaded->rounds < MAG_ROUNDS) {
+        mem_magazine_put(loaded, ptr);
+        cache->frees++;
+        return;
+    }
+
+    struct mem_magazine *previous = cache->previous[cls];
+
+    if (previous != nullptr && previous->rounds == 0) {
+        cache->loaded[cls] = previous;
+        cache->previous[cls] = loaded;
+        mem_magazine_put(previous, ptr);
+        cache->frees++;
+        return;
+    }
+
+    struct mem_magazine *empty = nullptr;
+
+    {
+        std::lock_guard<std::spin_lock> guard(sMemDepotLock);
+        empty = mem_magazine_pop(&sMemDepot.empty[cls]);
+    }
+
+    if (empty == nullptr) {
+        std::lock_guard<std::spin_lock> guard(sMemDefaultArena.lock);
+        empty = reinterpret_cast<struct mem_magazine *>(mem_heap_malloc(&sMemDefaultArena, sizeof(struct mem_magazine)));
+
+        if (empty == nullptr) {
+            if (mem_heap_free(&sMemDefaultArena, ptr)) {
+                sMemDefaultArena.stats.frees++;
+            }
+
+            return;
+        }
+
+        empty->rounds = 0;
+    }
+
+    if (previous != nullptr) {
+        std::lock_guard<std::spin_lock> guard(sMemDepotLock);
+        mem_magazine_push(&sMemDepot.full[cls], previous);
+    }
+
+    cache->previous[cls] = loaded;
+    cache->loaded[cls] = empty;
+    mem_magazine_put(empty, ptr);
+    cache->frees++;
+}
+
+/* Gives cached blocks and magazine itself back to heap, heap lock is held */
+
+static void mem_magazine_release(struct mem_magazine *mag)
+{
+    if (mag != nullptr) {
+        for (size_t i = 0; i < mag->rounds; i++) {
+            mem_heap_free(&sMemDefaultArena, mag->objs[i]);
+        }
+
+        mem_heap_free(&sMemDefaultArena, mag);
+    }
+}
+
+#ifdef MALLOC_TRACE
+
+/*
+ * Allocation trace. Records are logged under their own lock so tracing doesn't
+ * change which locks allocator paths take, it only serializes them.
+ */
+static struct mem_trace_record *sMemTraceRing = nullptr;
+static size_t sMemTraceCapacity = 0;
+/* records logged since start, ring slot is count modulo capacity */
+static size_t sMemTraceCount = 0;
+static unsigned long long (*sMemTraceClock)(void) = nullptr;
+static bool sMemTraceEnabled = false;
+static std::spin_lock sMemTraceLock;
+
+static void mem_trace(int op, size_t size, size_t alignment, void *ptr, void *old_ptr)
+{
+    /* don't serialize allocator paths while tracing is stopped */
+    if (!__atomic_load_n(&sMemTraceEnabled, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    std::lock_guard<std::spin_lock> guard(sMemTraceLock);
+
+    if (!sMemTraceEnabled) {
+        return;
+    }
+
+    struct mem_trace_record *rec = &sMemTraceRing[sMemTraceCount % sMemTraceCapacity];
+    rec->timestamp = sMemTraceClock != nullptr ? sMemTraceClock() : sMemTraceCount;
+    rec->size = size;
+    rec->alignment = alignment;
+    rec->ptr = reinterpret_cast<size_t>(ptr);
+    rec->old_ptr = reinterpret_cast<size_t>(old_ptr);
+    rec->op = op;
+    sMemTraceCount++;
+}
+
+#else /* MALLOC_TRACE */
+
+static inline void mem_trace(int, size_t, size_t, void *, void *)
+{
+}
+
+#endif /* MALLOC_TRACE */
+
+static void *mem_malloc_unlogged(size_t size)
+{
+    if (sMemCpuCount > 0 && size <= MAG_MAX_SIZE) {
+        return mem_magazine_alloc(mem_magazine_class(mem_adjust_size(size)));
+    }
+
+    return mem_arena_malloc(&sMemDefaultArena, size);
+}
+
+/**
+ * @brief malloc - allocates unused space for an object whose size in bytes is
+ *                 specified by size and whose value is unspecified.
+ * @param size   - desired size of block for allocation
+ * @return         Upon successful completion with size not equal to 0, malloc()
+ *                 shall return a pointer to the allocated space. If size is 0,
+ *                 either:
+ *
+ * A null pointer shall be returned and errno set to 0
+ * Otherwise, it shall return a null pointer and set errno to ENOMEM
+ */
+void *mem_malloc(size_t size)
+{
+    void *ptr = mem_malloc_unlogged(size);
+    mem_trace(MEM_TRACE_MALLOC, size, 0, ptr, nullptr);
+    return ptr;
+}
+
+/**
+ * @brief free - deallocate previously allocated via alloc() memory
+ * @param ptr  - pointer to previously allocated block
+ *
+ * if the argument does not match a pointer earlier returned by a function
+ * in POSIX.1-2017 that allocates memory as if by malloc(), or if the space has
+ * been deallocated by a call to free() or realloc(), the behavior is undefined.
+ *
+ * Any use of a pointer that refers to freed space results in undefined behavior.
+ */
+void mem_free(void *ptr)
+{
+    if (ptr != nullptr) {
+        mem_trace(MEM_TRACE_FREE, 0, 0, ptr, nullptr);
+    }
+
+    if (sMemCpuCount > 0 && mem_arena_owns(&sMemDefaultArena, ptr) && mem_block_allocated(ptr)) {
+        size_t size = mem_block_size(ptr);
+
+        if (mem_block_cached(ptr)) {
+            ALOGE("%s(): Invalid pointer\n", __func__);
+            return;
+        }
+
+        /* only blocks of exact class size may be handed out by magazines */
+        if (size <= MAG_MAX_SIZE && size % MAG_CLASS_GRANULE == 0) {
+            mem_magazine_free(ptr, mem_magazine_class(size));
+            return;
+        }
+    }
+
+    mem_arena_free(&sMemDefaultArena, ptr);
+}
+
+/**
+ * @brief realloc - deallocates the old object pointed to by ptr and return
+ *                  a pointer to a new object that has the size specified by size.
+ * @param ptr     - pointer to previously allocated via malloc() block
+ * @param size    - new desired size of newly allocated block
+ * @return        - newly allocated block with the same content or NULL
+ *                  In case of error errno is set to ENOMEM
+ *
+ * The contents of the new object is the same as that of the old object prior
+ * to deallocation, up to the lesser of the new and old sizes.
+ * Any bytes in the new object beyond the size of the old object have
+ * indeterminate values. If the size of the space requested is zero, then
+ * returns the same pointer
+ */
+void *mem_realloc(void *ptr, size_t size)
+{
+    void *blk = mem_arena_realloc(&sMemDefaultArena, ptr, size);
+    mem_trace(MEM_TRACE_REALLOC, size, 0, blk, ptr);
+    return blk;
+}
+
+/**
+ * @brief aligned_alloc - allocates space for an object whose alignment is
+ *                        specified by alignment and whose size is specified
+ *                        by size
+ * @param alignment     - power of two alignment of returned pointer
+ * @param size          - desired size of block for allocation
+ * @return                pointer to allocated space or NULL if alignment
+ *                        isn't supported or there is no memory
+ *
+ * Slack in front of aligned block is given back to heap, so aligned block
+ * costs the same as block of the same size returned by malloc().
+ */
+void *mem_aligned_alloc(size_t alignment, size_t size)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        return nullptr;
+    }
+
+    void *ptr = mem_arena_aligned_alloc(&sMemDefaultArena, alignment, size);
+    mem_trace(MEM_TRACE_ALIGNED_ALLOC, size, alignment, ptr, nullptr);
+    return ptr;
+}
+
+/**
+ * @brief posix_memalign - allocates size bytes aligned on a boundary
+ *                         specified by alignment
+ * @param memptr         - where to store pointer to allocated memory
+ * @param alignment      - power of two multiple of sizeof(void *)
+ * @param size           - desired size of block for allocation
+ * @return                 0 on success, EINVAL if alignment is invalid or
+ *                         ENOMEM if there is no memory
+ */
+int mem_posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+    if (memptr == nullptr || alignment == 0 || alignment % sizeof(void *) != 0
+        || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+
+    void *p = mem_aligned_alloc(alignment, size);
+
+    if (p == nullptr) {
+        return ENOMEM;
+    }
+
+    *memptr = p;
+    return 0;
+}
+
+/**
+ * @brief calloc - allocates unused space for an array of count elements each of
+ *                 whose size in bytes is size. Each byte of allocated memory is
+ *                 set to 0
+ * @param count  - count of an array elements
+ * @param size   - size of one element of the array
+ * @return       - allocated memory or NULL pointer. In case of error
+ *                 errno is set to ENOMEM
+ */
+void *mem_calloc(size_t count, size_t size)
+{
+    if (size != 0 && count > static_cast<size_t>(-1) / size) {
+        return nullptr;
+    }
+
+    size_t total = count * size;
+    void *p;
+
+    if (sMemCpuCount > 0 && total <= MAG_MAX_SIZE) {
+        /* cached blocks have been used before */
+        p = mem_malloc_unlogged(total);
+
+        if (p != nullptr) {
+            memset(p, 0, total);
+        }
+    }
+    else {
+        p = mem_arena_calloc(&sMemDefaultArena, total);
+    }
+
+    mem_trace(MEM_TRACE_MALLOC, total, 0, p, nullptr);
+    return p;
+}
+
+int mem_percpu_init(unsigned int cpu_count, unsigned int (*cpu_id)(void))
+{
+    if (cpu_count == 0 || cpu_count > MAG_MAX_CPUS || cpu_id == nullptr) {
+        return EINVAL;
+    }
+
+    sMemCpuId = cpu_id;
+    sMemCpuCount = cpu_count;
+    return 0;
+}
+
+void mem_percpu_drain()
+{
+    std::lock_guard<std::spin_lock> depot_guard(sMemDepotLock);
+    std::lock_guard<std::spin_lock> guard(sMemDefaultArena.lock);
+
+    for (unsigned int cpu = 0; cpu < sMemCpuCount; cpu++) {
+        for (int cls = 0; cls < MAG_CLASSES_COUNT; cls++) {
+            mem_magazine_release(sMemCpuCaches[cpu].loaded[cls]);
+            mem_magazine_release(sMemCpuCaches[cpu].previous[cls]);
+            sMemCpuCaches[cpu].loaded[cls] = nullptr;
+            sMemCpuCaches[cpu].previous[cls] = nullptr;
+        }
+    }
+
+    for (int cls = 0; cls < MAG_CLASSES_COUNT; cls++) {
+        struct mem_magazine *mag = nullptr;
+
+        while ((mag = mem_magazine_pop(&sMemDepot.full[cls])) != nullptr) {
+            mem_magazine_release(mag);
+        }
+
+        while ((mag = mem_magazine_pop(&sMemDepot.empty[cls])) != nullptr) {
+            mem_magazine_release(mag);
+        }
+    }
+}
+
+static int mem_init_default(void *start, size_t sizeInBytes, bool zeroed)
+{
+    std::lock_guard<std::spin_lock> guard(sMemDefaultArena.lock);
+    int ret = mem_arena_setup(&sMemDefaultArena, start, sizeInBytes, zeroed);
+
+    if (ret == 0) {
+        /* cached blocks belong to previous heap */
+        sMemCpuCount = 0;
+        sMemCpuId = nullptr;
+        memset(sMemCpuCaches, 0, sizeof(sMemCpuCaches));
+        memset(&sMemDepot, 0, sizeof(sMemDepot));
+    }
+
+    return ret;
+}
+
+int mem_init(void *start, size_t sizeInBytes)
+{
+    return mem_init_default(start, sizeInBytes, false);
+}
+
+int mem_init_zeroed(void *start, size_t sizeInBytes)
+{
+    return mem_init_default(start, sizeInBytes, true);
+}
+
+void mem_get_stats(struct mem_stats *stats)
+{
+    if (stats == nullptr) {
+        return;
+    }
+
+    mem_arena_get_stats(&sMemDefaultArena, stats);
+
+    /* magazine counters are CPU local, sum may miss requests in flight */
+    for (unsigned int cpu = 0; cpu < sMemCpuCount; cpu++) {
+        stats->allocs += sMemCpuCaches[cpu].allocs;
+        stats->frees += sMemCpuCaches[cpu].frees;
+    }
+}
+
+#ifdef MALLOC_TRACE
+
+int mem_trace_start(struct mem_trace_record *ring, size_t capacity,
+                    unsigned long long (*clock)(void))
+{
+    if (ring == nullptr || capacity == 0) {
+        return EINVAL;
+    }
+
+    std::lock_guard<std::spin_lock> guard(sMemTraceLock);
+    sMemTraceRing = ring;
+    sMemTraceCapacity = capacity;
+    sMemTraceCount = 0;
+    sMemTraceClock = clock;
+    sMemTraceEnabled = true;
+    return 0;
+}
+
+size_t mem_trace_stop()
+{
+    std::lock_guard<std::spin_lock> guard(sMemTraceLock);
+    /* ring stays readable until tracing is started again */
+    sMemTraceEnabled = false;
+    return sMemTraceCount;
+}
+
+size_t mem_trace_read(struct mem_trace_record *records, size_t count)
+{
+    std::lock_guard<std::spin_lock> guard(sMemTraceLock);
+    size_t available = sMemTraceCount < sMemTraceCapacity ? sMemTraceCount : sMemTraceCapacity;
+    size_t first = sMemTraceCount - available;
+
+    if (records == nullptr) {
+        return 0;
+    }
+
+    if (count > available) {
+        count = available;
+    }
+
+    /* skip the oldest records which don't fit */
+    first += available - count;
+
+    for (size_t i = 0; i < count; i++) {
+        records[i] = sMemTraceRing[(first + i) % sMemTraceCapacity];
+    }
+
+    return count;
+}
+
+void mem_trace_dump()
+{
+    std::lock_guard<std::spin_lock> guard(sMemTraceLock);
+    size_t available = sMemTraceCount < sMemTraceCapacity ? sMemTraceCount : sMemTraceCapacity;
+
+    for (size_t i = sMemTraceCount - available; i < sMemTraceCount; i++) {
+        struct mem_trace_record *rec = &sMemTraceRing[i % sMemTraceCapacity];
+        ALOGD("%llu %c %lu %lu %#lx %#lx", rec->timestamp, rec->op, rec->size,
+              rec->alignment, rec->ptr, rec->old_ptr);
+    }
+}
+
+#else /* MALLOC_TRACE */
+
+int mem_trace_start(struct mem_trace_record *, size_t, unsigned long long (*)(void))
+{
+    return ENOSYS;
+}
+
+size_t mem_trace_stop()
+{
+    return 0;
+}
+
+size_t mem_trace_read(struct mem_trace_record *, size_t)
+{
+    return 0;
+}
+
+void mem_trace_dump()
+{
+    ALOGD("Tracing is not compiled in");
+}
+
+#endif /* MALLOC_TRACE */
+
+void mem_dump()
+{
+    mem_arena_dump(&sMemDefaultArena);
+}
+
+struct mem_arena *arena_init(void *start, size_t sizeInBytes)
+{
+    size_t addr = (reinterpret_cast<size_t>(start) + alignof(struct mem_arena) - 1)
+        & ~(alignof(struct mem_arena) - 1);
+    size_t header_size = addr - reinterpret_cast<size_t>(start) + sizeof(struct mem_arena);
+
+    if (start == nullptr || sizeInBytes < header_size) {
+        return nullptr;
+    }
+
+    struct mem_arena *arena = reinterpret_cast<struct mem_arena *>(addr);
+    /* zeroed lock is unlocked */
+    memset(arena, 0, sizeof(struct mem_arena));
+
+    if (mem_arena_setup(arena, CHAR_PTR(start) + header_size, sizeInBytes - header_size, false) != 0) {
+        return nullptr;
+    }
+
+    return arena;
+}
+
+void *arena_malloc(struct mem_arena *arena, size_t size)
+{
+    return mem_arena_malloc(arena, size);
+}
+
+void arena_free(struct mem_arena *arena, void *ptr)
+{
+    mem_arena_free(arena, ptr);
+}
+
+void *arena_realloc(struct mem_arena *arena, void *ptr, size_t size)
+{
+    return mem_arena_realloc(arena, ptr, size);
+}
+
+void arena_get_stats(struct mem_arena *arena, struct mem_stats *stats)
+{
+    if (stats != nullptr) {
+        mem_arena_get_stats(arena, stats);
+    }
+}
+
+void arena_dump(struct mem_arena *arena)
+{
+    mem_arena_dump(arena);
+}
+
+__END_DECLS
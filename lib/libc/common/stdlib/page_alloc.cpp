@@ -0,0 +1,276 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+#include <asm/page.h>
+#include <macondo/page_alloc.h>
+#include <macondo/spin_lock.h>
+
+__BEGIN_DECLS
+
+#define LOG_TAG "PageAlloc"
+
+#include <linux_debug.h>
+
+#define BITS_PER_LONG (sizeof(unsigned long) * 8)
+#define MAX_BLOCK_SIZE ((size_t) PAGE_SIZE << PAGE_MAX_ORDER)
+
+/* free block keeps list links in its first page */
+struct page_block {
+    struct page_block *next;
+    struct page_block *prev;
+};
+
+/*
+ * Page indexes are counted from address aligned to the biggest block, so
+ * buddies are found by flipping bit of index and blocks are aligned to their
+ * size. Pages in [sPageBase, first page) don't belong to the allocator and
+ * are never free, so they are never merged with.
+ */
+static char *sPageBase = nullptr;
+static size_t sPageFirst = 0;
+static size_t sPageLast = 0;
+static struct page_block *sPageFreeLists[PAGE_ORDER_COUNT];
+/* bit is set when exactly one block of buddy pair is free */
+static unsigned long *sPageBuddyMap[PAGE_MAX_ORDER];
+static struct page_alloc_stats sPageStats;
+static std::spin_lock sPageLock;
+
+static inline struct page_block *page_block_at(size_t index)
+{
+    return reinterpret_cast<struct page_block *>(sPageBase + index * PAGE_SIZE);
+}
+
+static inline size_t page_index(void *addr)
+{
+    return (reinterpret_cast<char *>(addr) - sPageBase) / PAGE_SIZE;
+}
+
+static inline bool page_toggle_buddy_bit(unsigned int order, size_t index)
+{
+    size_t pair = index >> (order + 1);
+    unsigned long mask = 1UL << (pair % BITS_PER_LONG);
+    unsigned long *word = &sPageBuddyMap[order][pair / BITS_PER_LONG];
+    *word ^= mask;
+    return (*word & mask) != 0;
+}
+
+static void page_list_insert(unsigned int order, size_t index)
+{
+    struct page_block *block = page_block_at(index);
+    block->next = sPageFreeLists[order];
+    block->prev = nullptr;
+
+    if (block->next != nullptr) {
+        block->next->prev = block;
+    }
+
+    sPageFreeLists[order] = block;
+    sPageStats.free_blocks[order]++;
+}
+
+static void page_list_remove(unsigned int order, struct page_block *block)
+{
+    if (block->prev != nullptr) {
+        block->prev->next = block->next;
+    }
+    else {
+        sPageFreeLists[order] = block->next;
+    }
+
+    if (block->next != nullptr) {
+        block->next->prev = block->prev;
+    }
+
+    sPageStats.free_blocks[order]--;
+}
+
+static void page_free_block(size_t index, unsigned int order)
+{
+    for (; order < PAGE_MAX_ORDER; order++) {
+        /* buddy is allocated or split, nothing to merge with */
+        if (page_toggle_buddy_bit(order, index)) {
+            break;
+        }
+
+        size_t buddy = index ^ (1UL << order);
+        page_list_remove(order, page_block_at(buddy));
+        index &= ~(1UL << order);
+    }
+
+    page_list_insert(order, index);
+}
+
+int page_alloc_init(void *start, size_t size)
+{
+    size_t begin = (reinterpret_cast<size_t>(start) + PAGE_SIZE - 1) & ~(size_t) (PAGE_SIZE - 1);
+    size_t end = (reinterpret_cast<size_t>(start) + size) & ~(size_t) (PAGE_SIZE - 1);
+
+    if (start == nullptr || end <= begin) {
+        return EINVAL;
+    }
+
+    std::lock_guard<std::spin_lock> guard(sPageLock);
+    sPageBase = reinterpret_cast<char *>(begin & ~(MAX_BLOCK_SIZE - 1));
+    sPageFirst = (begin - reinterpret_cast<size_t>(sPageBase)) / PAGE_SIZE;
+    sPageLast = (end - reinterpret_cast<size_t>(sPageBase)) / PAGE_SIZE;
+
+    /* buddy bitmaps live in the first pages of region */
+    size_t words[PAGE_MAX_ORDER];
+    size_t total_words = 0;
+
+    for (unsigned int order = 0; order < PAGE_MAX_ORDER; order++) {
+        size_t pairs = (sPageLast + (2UL << order) - 1) >> (order + 1);
+        words[order] = (pairs + BITS_PER_LONG - 1) / BITS_PER_LONG;
+        total_words += words[order];
+    }
+
+    size_t meta_pages = (total_words * sizeof(unsigned long) + PAGE_SIZE - 1) / PAGE_SIZE;
+
+    if (sPageFirst + meta_pages >= sPageLast) {
+        sPageBase = nullptr;
+        return EINVAL;
+    }
+
+    unsigned long *map = reinterpret_cast<unsigned long *>(begin);
+    memset(map, 0, total_words * sizeof(unsigned long));
+
+    for (unsigned int order = 0; order < PAGE_MAX_ORDER; order++) {
+        sPageBuddyMap[order] = map;
+        map += words[order];
+    }
+
+    sPageFirst += meta_pages;
+    memset(sPageFreeLists, 0, sizeof(sPageFreeLists));
+    memset(&sPageStats, 0, sizeof(sPageStats));
+    sPageStats.total_pages = sPageLast - sPageFirst;
+    sPageStats.free_pages = sPageStats.total_pages;
+
+    /* hand out region as the biggest aligned blocks which fit into it */
+    for (size_t index = sPageFirst; index < sPageLast;) {
+        unsigned int order = PAGE_MAX_ORDER;
+
+        while (order > 0 && ((index & ((1UL << order) - 1)) != 0 || index + (1UL << order) > sPageLast)) {
+            order--;
+        }
+
+        page_free_block(index, order);
+        index += 1UL << order;
+    }
+
+    return 0;
+}
+
+void *page_alloc(unsigned int order)
+{
+    if (order > PAGE_MAX_ORDER) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::spin_lock> guard(sPageLock);
+    unsigned int cur = order;
+
+    while (cur <= PAGE_MAX_ORDER && sPageFreeLists[cur] == nullptr) {
+        cur++;
+    }
+
+    if (cur > PAGE_MAX_ORDER) {
+        sPageStats.failures++;
+        return nullptr;
+    }
+
+    struct page_block *block = sPageFreeLists[cur];
+    size_t index = page_index(block);
+    page_list_remove(cur, block);
+
+    if (cur < PAGE_MAX_ORDER) {
+        page_toggle_buddy_bit(cur, index);
+    }
+
+    /* split block and give upper halves back */
+    while (cur > order) {
+        cur--;
+        page_list_insert(cur, index + (1UL << cur));
+        page_toggle_buddy_bit(cur, index);
+    }
+
+    sPageStats.allocs++;
+    sPageStats.free_pages -= 1UL << order;
+    return page_block_at(index);
+}
+
+void page_free(void *addr, unsigned int order)
+{
+    if (addr == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::spin_lock> guard(sPageLock);
+    size_t index = page_index(addr);
+
+    if (order > PAGE_MAX_ORDER || sPageBase == nullptr || reinterpret_cast<char *>(addr) < sPageBase
+        || index < sPageFirst || index + (1UL << order) > sPageLast
+        || (index & ((1UL << order) - 1)) != 0 || page_block_at(index) != addr) {
+        ALOGE("%s(): Invalid block %p of order %u\n", __func__, addr, order);
+        return;
+    }
+
+    page_free_block(index, order);
+    sPageStats.frees++;
+    sPageStats.free_pages += 1UL << order;
+}
+
+unsigned int page_order(size_t size)
+{
+    size_t pages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+    return pages <= 1 ? 0 : (unsigned int) flsl((long) (pages - 1));
+}
+
+void page_alloc_get_stats(struct page_alloc_stats *stats)
+{
+    std::lock_guard<std::spin_lock> guard(sPageLock);
+    *stats = sPageStats;
+}
+
+unsigned int page_alloc_fragmentation(unsigned int order)
+{
+    std::lock_guard<std::spin_lock> guard(sPageLock);
+
+    if (order > PAGE_MAX_ORDER || sPageStats.free_pages == 0) {
+        return 0;
+    }
+
+    size_t usable = 0;
+
+    for (unsigned int cur = order; cur <= PAGE_MAX_ORDER; cur++) {
+        usable += sPageStats.free_blocks[cur] << cur;
+    }
+
+    return (unsigned int) ((sPageStats.free_pages - usable) * 1000 / sPageStats.free_pages);
+}
+
+__END_DECLS
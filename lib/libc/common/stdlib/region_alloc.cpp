@@ -0,0 +1,175 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <macondo/region_alloc.h>
+
+__BEGIN_DECLS
+
+#define CHAR_PTR(ptr) (reinterpret_cast<char*>(ptr))
+#define ALIGN_UP(value, align) (((value) + (align) - 1) & ~((align) - 1))
+
+/* first chunk taken from heap when caller doesn't give its size */
+#define REGION_DEFAULT_CHUNK_SIZE 4096
+/* chunks double in size until they reach this limit */
+#define REGION_MAX_CHUNK_SIZE (1 << 20)
+#define REGION_CHUNK_ALIGN 16
+
+struct region_chunk {
+    struct region_chunk *next;
+    /* bytes available after header */
+    size_t size;
+    /* chunk is taken from heap, not given by caller */
+    bool owned;
+};
+
+#define REGION_CHUNK_HEADER_SIZE ALIGN_UP(sizeof(struct region_chunk), REGION_CHUNK_ALIGN)
+
+static inline char *region_chunk_data(struct region_chunk *chunk)
+{
+    return CHAR_PTR(chunk) + REGION_CHUNK_HEADER_SIZE;
+}
+
+static inline void region_use_chunk(struct region *region, struct region_chunk *chunk)
+{
+    region->current = chunk;
+    region->ptr = region_chunk_data(chunk);
+    region->end = region->ptr + chunk->size;
+}
+
+void region_init(struct region *region, void *buffer, size_t size, size_t chunk_size)
+{
+    memset(region, 0, sizeof(struct region));
+    region->chunk_size = chunk_size != 0 ? chunk_size : REGION_DEFAULT_CHUNK_SIZE;
+
+    if (buffer != nullptr) {
+        size_t addr = ALIGN_UP(reinterpret_cast<size_t>(buffer), REGION_CHUNK_ALIGN);
+        size_t lead = addr - reinterpret_cast<size_t>(buffer);
+
+        if (size > lead + REGION_CHUNK_HEADER_SIZE) {
+            struct region_chunk *chunk = reinterpret_cast<struct region_chunk *>(addr);
+            chunk->next = nullptr;
+            chunk->size = size - lead - REGION_CHUNK_HEADER_SIZE;
+            chunk->owned = false;
+            region->head = chunk;
+            region_use_chunk(region, chunk);
+        }
+    }
+}
+
+void *region_alloc_slow(struct region *region, size_t size, size_t align)
+{
+    /* chunks kept by region_reset() are reused first */
+    while (region->current != nullptr && region->current->next != nullptr) {
+        region_use_chunk(region, region->current->next);
+        size_t addr = ALIGN_UP(reinterpret_cast<size_t>(region->ptr), align);
+
+        if (addr <= reinterpret_cast<size_t>(region->end)
+            && size <= reinterpret_cast<size_t>(region->end) - addr) {
+            region->ptr = CHAR_PTR(addr) + size;
+            return CHAR_PTR(addr);
+        }
+    }
+
+    size_t padding = align > REGION_CHUNK_ALIGN ? align - REGION_CHUNK_ALIGN : 0;
+    size_t need = size + padding;
+
+    if (need < size || need + REGION_CHUNK_HEADER_SIZE < need) {
+        return nullptr;
+    }
+
+    size_t chunk_size = need > region->chunk_size ? need : region->chunk_size;
+    void *mem = mem_aligned_alloc(REGION_CHUNK_ALIGN, chunk_size + REGION_CHUNK_HEADER_SIZE);
+
+    /* don't fail because of geometric growth, exact size may still fit */
+    if (mem == nullptr && chunk_size > need) {
+        chunk_size = need;
+        mem = mem_aligned_alloc(REGION_CHUNK_ALIGN, chunk_size + REGION_CHUNK_HEADER_SIZE);
+    }
+
+    if (mem == nullptr) {
+        return nullptr;
+    }
+
+    struct region_chunk *chunk = reinterpret_cast<struct region_chunk *>(mem);
+    chunk->next = nullptr;
+    chunk->size = chunk_size;
+    chunk->owned = true;
+
+    if (region->current != nullptr) {
+        region->current->next = chunk;
+    }
+    else {
+        region->head = chunk;
+    }
+
+    if (region->chunk_size < REGION_MAX_CHUNK_SIZE) {
+        region->chunk_size *= 2;
+    }
+
+    region_use_chunk(region, chunk);
+    size_t addr = ALIGN_UP(reinterpret_cast<size_t>(region->ptr), align);
+    region->ptr = CHAR_PTR(addr) + size;
+    return CHAR_PTR(addr);
+}
+
+void region_reset(struct region *region)
+{
+    if (region->head != nullptr) {
+        region_use_chunk(region, region->head);
+    }
+}
+
+void region_destroy(struct region *region)
+{
+    struct region_chunk *chunk = region->head;
+    struct region_chunk *keep = nullptr;
+
+    /* only the first chunk may be given by caller */
+    if (chunk != nullptr && !chunk->owned) {
+        keep = chunk;
+        chunk = chunk->next;
+        keep->next = nullptr;
+    }
+
+    while (chunk != nullptr) {
+        struct region_chunk *next = chunk->next;
+        mem_free(chunk);
+        chunk = next;
+    }
+
+    region->head = keep;
+    region->current = keep;
+    region->ptr = nullptr;
+    region->end = nullptr;
+
+    if (keep != nullptr) {
+        region_use_chunk(region, keep);
+    }
+}
+
+__END_DECLS
@@ -0,0 +1,309 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <string.h>
+#include <macondo/string_simd.h>
+
+/*
+ * Vectors are 16 bytes. Loads which search for a terminator or a needle are
+ * aligned so they never cross a page boundary, lanes outside the range are
+ * masked. Lane masks are little endian.
+ */
+typedef unsigned char __attribute__((vector_size(16), __may_alias__)) v16u8;
+typedef unsigned char __attribute__((vector_size(16), __may_alias__, __aligned__(1))) v16u8_u;
+typedef signed char __attribute__((vector_size(16))) v16s8;
+typedef unsigned long __attribute__((vector_size(16))) v2u64;
+
+typedef unsigned long __attribute__((__may_alias__, __aligned__(1))) uword_u;
+typedef unsigned int __attribute__((__may_alias__, __aligned__(1))) u32_u;
+typedef unsigned short __attribute__((__may_alias__, __aligned__(1))) u16_u;
+
+#define VEC_SIZE 16
+
+static const v16u8 kLanes = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+static inline v16u8 splat(unsigned char c) {
+    return (v16u8) {} + c;
+}
+
+static inline v16u8 load(const unsigned char *p) {
+    return *(const v16u8_u *) p;
+}
+
+static inline void store(unsigned char *p, v16u8 v) {
+    *(v16u8_u *) p = v;
+}
+
+static inline int any_lane(v16s8 mask) {
+    v2u64 m = (v2u64) mask;
+    return (m[0] | m[1]) != 0;
+}
+
+/* mask must have a lane set */
+static inline size_t first_lane(v16s8 mask) {
+    v2u64 m = (v2u64) mask;
+    return m[0] != 0 ? __builtin_ctzl(m[0]) / 8 : 8 + __builtin_ctzl(m[1]) / 8;
+}
+
+/* Copies less than VEC_SIZE bytes with overlapping head and tail */
+static inline void copy_small(unsigned char *d, const unsigned char *s, size_t length) {
+    if (length >= 8) {
+        unsigned long head = *(const uword_u *) s;
+        unsigned long tail = *(const uword_u *) (s + length - 8);
+        *(uword_u *) d = head;
+        *(uword_u *) (d + length - 8) = tail;
+    } else if (length >= 4) {
+        unsigned int head = *(const u32_u *) s;
+        unsigned int tail = *(const u32_u *) (s + length - 4);
+        *(u32_u *) d = head;
+        *(u32_u *) (d + length - 4) = tail;
+    } else if (length >= 2) {
+        unsigned short head = *(const u16_u *) s;
+        unsigned short tail = *(const u16_u *) (s + length - 2);
+        *(u16_u *) d = head;
+        *(u16_u *) (d + length - 2) = tail;
+    } else if (length == 1) {
+        *d = *s;
+    }
+}
+
+void *simd_memcpy(void *__restrict__ dest, const void *__restrict__ src, size_t length) {
+    unsigned char *d = (unsigned char *) dest;
+    const unsigned char *s = (const unsigned char *) src;
+    unsigned char *end;
+    size_t skip;
+    v16u8 head;
+    v16u8 tail;
+
+    if (length < VEC_SIZE) {
+        copy_small(d, s, length);
+        return dest;
+    }
+
+    head = load(s);
+    tail = load(s + length - VEC_SIZE);
+
+    if (length <= 2 * VEC_SIZE) {
+        store(d, head);
+        store(d + length - VEC_SIZE, tail);
+        return dest;
+    }
+
+    /* head covers bytes skipped to align destination, tail the last vector */
+    store(d, head);
+    end = d + length - VEC_SIZE;
+    skip = VEC_SIZE - ((size_t) d & (VEC_SIZE - 1));
+    d += skip;
+    s += skip;
+
+    while (d + 2 * VEC_SIZE <= end) {
+        v16u8 v0 = load(s);
+        v16u8 v1 = load(s + VEC_SIZE);
+        *(v16u8 *) d = v0;
+        *(v16u8 *) (d + VEC_SIZE) = v1;
+        d += 2 * VEC_SIZE;
+        s += 2 * VEC_SIZE;
+    }
+
+    while (d < end) {
+        *(v16u8 *) d = load(s);
+        d += VEC_SIZE;
+        s += VEC_SIZE;
+    }
+
+    store(end, tail);
+    return dest;
+}
+
+#ifdef __aarch64__
+/* below it vector stores are as fast as DC ZVA */
+#define ZVA_MIN 256
+
+/* returns DC ZVA block size or 0 if DC ZVA is prohibited */
+static inline size_t zva_block_size(void) {
+    unsigned long dczid;
+
+    __asm__ ("mrs %0, dczid_el0" : "=r" (dczid));
+    return (dczid & 0x10) != 0 ? 0 : 4UL << (dczid & 0xf);
+}
+#endif
+
+void *simd_memset(void *dest, int value, size_t length) {
+    unsigned char *d = (unsigned char *) dest;
+    v16u8 v = splat((unsigned char) value);
+    unsigned char *end;
+
+    if (length < VEC_SIZE) {
+        unsigned long w = (~0UL / 0xff) * (unsigned char) value;
+
+        if (length >= 8) {
+            *(uword_u *) d = w;
+            *(uword_u *) (d + length - 8) = w;
+        } else if (length >= 4) {
+            *(u32_u *) d = (unsigned int) w;
+            *(u32_u *) (d + length - 4) = (unsigned int) w;
+        } else if (length >= 2) {
+            *(u16_u *) d = (unsigned short) w;
+            *(u16_u *) (d + length - 2) = (unsigned short) w;
+        } else if (length == 1) {
+            *d = (unsigned char) w;
+        }
+
+        return dest;
+    }
+
+#ifdef __aarch64__
+    /* whole cache lines are zeroed without being read in */
+    if (value == 0 && length >= ZVA_MIN) {
+        size_t block = zva_block_size();
+
+        if (block != 0 && length >= 2 * block) {
+            unsigned char *p = (unsigned char *) (((size_t) d + block - 1) & ~(block - 1));
+
+            end = d + length;
+            simd_memset(d, 0, p - d);
+
+            for (; (size_t) (end - p) >= block; p += block) {
+                __asm__ __volatile__ ("dc zva, %0" : : "r" (p) : "memory");
+            }
+
+            simd_memset(p, 0, end - p);
+            return dest;
+        }
+    }
+#endif
+
+    end = d + length - VEC_SIZE;
+    store(d, v);
+    store(end, v);
+    d += VEC_SIZE - ((size_t) d & (VEC_SIZE - 1));
+
+    while (d + 2 * VEC_SIZE <= end) {
+        *(v16u8 *) d = v;
+        *(v16u8 *) (d + VEC_SIZE) = v;
+        d += 2 * VEC_SIZE;
+    }
+
+    while (d < end) {
+        *(v16u8 *) d = v;
+        d += VEC_SIZE;
+    }
+
+    return dest;
+}
+
+void *simd_memchr(const void *memory, int needle, size_t count) {
+    const unsigned char *s = (const unsigned char *) memory;
+    v16u8 pattern = splat((unsigned char) needle);
+    size_t offset = (size_t) s & (VEC_SIZE - 1);
+    const v16u8 *v = (const v16u8 *) (s - offset);
+    /* bytes from v to the end of range */
+    size_t limit = count > (size_t) -1 - offset ? (size_t) -1 : count + offset;
+    v16s8 mask;
+
+    if (count == 0) {
+        return NULL;
+    }
+
+    mask = (*v == pattern) & (kLanes >= (unsigned char) offset);
+
+    while (!any_lane(mask)) {
+        if (limit <= VEC_SIZE) {
+            return NULL;
+        }
+
+        limit -= VEC_SIZE;
+        mask = *++v == pattern;
+    }
+
+    return first_lane(mask) < limit ? (unsigned char *) v + first_lane(mask) : NULL;
+}
+
+int simd_memcmp(const void *first, const void *second, size_t length) {
+    const unsigned char *m1 = (const unsigned char *) first;
+    const unsigned char *m2 = (const unsigned char *) second;
+    size_t i = 0;
+    v16s8 ne;
+
+    if (length < VEC_SIZE) {
+        for (i = 0; i < length; i++) {
+            if (m1[i] != m2[i]) {
+                return m1[i] - m2[i];
+            }
+        }
+
+        return 0;
+    }
+
+    for (i = 0; i + VEC_SIZE <= length; i += VEC_SIZE) {
+        ne = load(m1 + i) != load(m2 + i);
+
+        if (any_lane(ne)) {
+            i += first_lane(ne);
+            return m1[i] - m2[i];
+        }
+    }
+
+    /* the last vector overlaps bytes already compared equal */
+    if (i < length) {
+        i = length - VEC_SIZE;
+        ne = load(m1 + i) != load(m2 + i);
+
+        if (any_lane(ne)) {
+            i += first_lane(ne);
+            return m1[i] - m2[i];
+        }
+    }
+
+    return 0;
+}
+
+size_t simd_strlen(const char *str) {
+    size_t offset = (size_t) str & (VEC_SIZE - 1);
+    const v16u8 *v = (const v16u8 *) (str - offset);
+    v16s8 mask = (*v == 0) & (kLanes >= (unsigned char) offset);
+
+    while (!any_lane(mask)) {
+        mask = *++v == 0;
+    }
+
+    return (const char *) v + first_lane(mask) - str;
+}
+
+char *simd_strchr(const char *str, int needle) {
+    v16u8 pattern = splat((unsigned char) needle);
+    size_t offset = (size_t) str & (VEC_SIZE - 1);
+    const v16u8 *v = (const v16u8 *) (str - offset);
+    v16s8 mask = ((*v == pattern) | (*v == 0)) & (kLanes >= (unsigned char) offset);
+    const char *s;
+
+    while (!any_lane(mask)) {
+        v++;
+        mask = (*v == pattern) | (*v == 0);
+    }
+
+    s = (const char *) v + first_lane(mask);
+    return *s == (char) needle ? (char *) s : NULL;
+}
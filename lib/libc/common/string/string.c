@@ -22,91 +22,384 @@
  * THE SOFTWARE.
  */
 
+#include <errno.h>
 #include <string.h>
 #include <ctype.h>
+#include <macondo/string_dispatch.h>
+#include "string_word.h"
 
-void *memcpy(void *__restrict__ dest, const void *__restrict__ src, size_t length) {
-    unsigned char *d = (unsigned char *) dest;
-    unsigned char *s = (unsigned char *) src;
+#ifdef LIBC_SIMD
+#include <macondo/string_simd.h>
+#endif
+
+/*
+ * Unaligned 4 and 2 byte accesses of copy helpers, see uword_u. Pairs of words
+ * are kept together to let them be merged into LDP/STP.
+ */
+typedef unsigned int __attribute__((__may_alias__, __aligned__(1))) u32_u;
+typedef unsigned short __attribute__((__may_alias__, __aligned__(1))) u16_u;
 
-    if (d == s) {
-        return d;
+#define COPY_ALIGN 16
+#define COPY_BLOCK 64
+
+/*
+ * Copies up to COPY_BLOCK bytes. Head and tail of the range are loaded before
+ * anything is stored and may overlap each other, so any overlap of dest and
+ * src is handled and there is no byte loop.
+ */
+static inline void copy_small(unsigned char *d, const unsigned char *s, size_t length) {
+    if (length >= 32) {
+        unsigned long a0 = *(const uword_u *) s;
+        unsigned long a1 = *(const uword_u *) (s + 8);
+        unsigned long a2 = *(const uword_u *) (s + 16);
+        unsigned long a3 = *(const uword_u *) (s + 24);
+        unsigned long b0 = *(const uword_u *) (s + length - 32);
+        unsigned long b1 = *(const uword_u *) (s + length - 24);
+        unsigned long b2 = *(const uword_u *) (s + length - 16);
+        unsigned long b3 = *(const uword_u *) (s + length - 8);
+        *(uword_u *) d = a0;
+        *(uword_u *) (d + 8) = a1;
+        *(uword_u *) (d + 16) = a2;
+        *(uword_u *) (d + 24) = a3;
+        *(uword_u *) (d + length - 32) = b0;
+        *(uword_u *) (d + length - 24) = b1;
+        *(uword_u *) (d + length - 16) = b2;
+        *(uword_u *) (d + length - 8) = b3;
+    } else if (length >= 16) {
+        unsigned long a0 = *(const uword_u *) s;
+        unsigned long a1 = *(const uword_u *) (s + 8);
+        unsigned long b0 = *(const uword_u *) (s + length - 16);
+        unsigned long b1 = *(const uword_u *) (s + length - 8);
+        *(uword_u *) d = a0;
+        *(uword_u *) (d + 8) = a1;
+        *(uword_u *) (d + length - 16) = b0;
+        *(uword_u *) (d + length - 8) = b1;
+    } else if (length >= 8) {
+        unsigned long a = *(const uword_u *) s;
+        unsigned long b = *(const uword_u *) (s + length - 8);
+        *(uword_u *) d = a;
+        *(uword_u *) (d + length - 8) = b;
+    } else if (length >= 4) {
+        unsigned int a = *(const u32_u *) s;
+        unsigned int b = *(const u32_u *) (s + length - 4);
+        *(u32_u *) d = a;
+        *(u32_u *) (d + length - 4) = b;
+    } else if (length >= 2) {
+        unsigned short a = *(const u16_u *) s;
+        unsigned short b = *(const u16_u *) (s + length - 2);
+        *(u16_u *) d = a;
+        *(u16_u *) (d + length - 2) = b;
+    } else if (length == 1) {
+        *d = *s;
     }
+}
 
-    while (length--) {
-        *d++ = *s++;
+/* Copies one COPY_BLOCK, d is COPY_ALIGN aligned */
+static inline void copy_block(unsigned char *d, const unsigned char *s) {
+    unsigned long w0 = *(const uword_u *) s;
+    unsigned long w1 = *(const uword_u *) (s + 8);
+    unsigned long w2 = *(const uword_u *) (s + 16);
+    unsigned long w3 = *(const uword_u *) (s + 24);
+    unsigned long w4 = *(const uword_u *) (s + 32);
+    unsigned long w5 = *(const uword_u *) (s + 40);
+    unsigned long w6 = *(const uword_u *) (s + 48);
+    unsigned long w7 = *(const uword_u *) (s + 56);
+    uword *dw = (uword *) d;
+    dw[0] = w0;
+    dw[1] = w1;
+    dw[2] = w2;
+    dw[3] = w3;
+    dw[4] = w4;
+    dw[5] = w5;
+    dw[6] = w6;
+    dw[7] = w7;
+}
+
+/*
+ * Copies ascending, safe when dest is below src. Destination is aligned first
+ * so only loads may be unaligned.
+ */
+static void copy_forward(unsigned char *d, const unsigned char *s, size_t length) {
+    size_t head = -(size_t) d & (COPY_ALIGN - 1);
+
+    copy_small(d, s, head);
+    d += head;
+    s += head;
+    length -= head;
+
+    while (length >= COPY_BLOCK) {
+        copy_block(d, s);
+        d += COPY_BLOCK;
+        s += COPY_BLOCK;
+        length -= COPY_BLOCK;
     }
 
-    return dest;
+    copy_small(d, s, length);
 }
 
-void *memmove(void *dest, const void *src, size_t length) {
+/* Copies descending, safe when dest is above src */
+static void copy_backward(unsigned char *d, const unsigned char *s, size_t length) {
+    unsigned char *de = d + length;
+    const unsigned char *se = s + length;
+    size_t tail = (size_t) de & (COPY_ALIGN - 1);
+
+    copy_small(de - tail, se - tail, tail);
+    de -= tail;
+    se -= tail;
+    length -= tail;
+
+    while (length >= COPY_BLOCK) {
+        de -= COPY_BLOCK;
+        se -= COPY_BLOCK;
+        copy_block(de, se);
+        length -= COPY_BLOCK;
+    }
+
+    copy_small(d, s, length);
+}
+
+static void *scalar_memcpy(void *__restrict__ dest, const void *__restrict__ src, size_t length) {
     unsigned char *d = (unsigned char *) dest;
-    unsigned char *s = (unsigned char *) src;
+    const unsigned char *s = (const unsigned char *) src;
 
-    if (s >= d) {
-        /* copy forward */
-        while (length-- > 0) {
-            *d++ = *s++;
-        }
-    } else if (s <= d) {
-        /* copy backward */
-        d += length;
-        s += length;
+    if (length <= COPY_BLOCK) {
+        copy_small(d, s, length);
+    } else {
+        copy_forward(d, s, length);
+    }
 
-        while (length-- > 0) {
-            *--d = *--s;
-        }
+    return dest;
+}
+
+static void *scalar_memmove(void *dest, const void *src, size_t length) {
+    unsigned char *d = (unsigned char *) dest;
+    const unsigned char *s = (const unsigned char *) src;
+
+    if (length <= COPY_BLOCK) {
+        copy_small(d, s, length);
+    } else if ((size_t) d - (size_t) s >= length) {
+        /* dest is below src or areas don't overlap */
+        copy_forward(d, s, length);
+    } else {
+        copy_backward(d, s, length);
     }
 
     return dest;
 }
 
-void *memchr(const void *memory, int needle, size_t count) {
-    unsigned char *p = (unsigned char *) memory;
+static void *scalar_memchr(const void *memory, int needle, size_t count) {
+    const unsigned char *s = (const unsigned char *) memory;
+    unsigned long pattern = ONES * (unsigned char) needle;
+    size_t offset = (size_t) s & (WORD_SIZE - 1);
+    const uword *w = (const uword *) (s - offset);
+    /* bytes from w to the end of range */
+    size_t limit = count > (size_t) -1 - offset ? (size_t) -1 : count + offset;
+    unsigned long mask;
 
-    while (count-- > 0) {
-        if (*p++ == (unsigned char) needle) {
-            return --p;
+    if (count == 0) {
+        return NULL;
+    }
+
+    mask = has_zero((*w ^ pattern) | below(offset));
+
+    while (mask == 0) {
+        if (limit <= WORD_SIZE) {
+            return NULL;
         }
+
+        limit -= WORD_SIZE;
+        mask = has_zero(*++w ^ pattern);
     }
 
-    return NULL;
+    return first_byte(mask) < limit ? (unsigned char *) w + first_byte(mask) : NULL;
 }
 
 void *memrchr(const void *mem, int needle, size_t count) {
-    unsigned char *s = (unsigned char *) mem + count - 1;
+    const unsigned char *s = (const unsigned char *) mem;
+    unsigned long pattern = ONES * (unsigned char) needle;
+    const unsigned char *found;
+    const uword *w;
+    size_t tail;
+    unsigned long x;
+    unsigned long mask;
+
+    if (count == 0) {
+        return NULL;
+    }
 
-    while (count-- > 0) {
-        if (*s-- == (unsigned char) needle) {
-            return ++s;
+    w = (const uword *) ((size_t) (s + count - 1) & ~(WORD_SIZE - 1));
+    tail = (size_t) (s + count) & (WORD_SIZE - 1);
+    x = *w ^ pattern;
+
+    if (tail != 0) {
+        x |= ~below(tail);
+    }
+
+    while ((mask = zero_bytes(x)) == 0) {
+        if ((const unsigned char *) w <= s) {
+            return NULL;
         }
+
+        x = *--w ^ pattern;
     }
 
-    return NULL;
+    found = (const unsigned char *) w + last_byte(mask);
+    return found >= s ? (void *) found : NULL;
 }
 
-int memcmp(const void *first, const void *second, size_t length) {
-    unsigned char *m1 = (unsigned char *) first;
-    unsigned char *m2 = (unsigned char *) second;
-    size_t i = 0;
+static int scalar_memcmp(const void *first, const void *second, size_t length) {
+    const unsigned char *m1 = (const unsigned char *) first;
+    const unsigned char *m2 = (const unsigned char *) second;
+    unsigned long a;
+    unsigned long b;
 
-    for (i = 0; i < length; i++) {
-        if (m1[i] != m2[i]) {
-            return m1[i] - m2[i];
+    if (length < WORD_SIZE) {
+        for (; length > 0; length--, m1++, m2++) {
+            if (*m1 != *m2) {
+                return *m1 - *m2;
+            }
         }
+
+        return 0;
     }
 
-    return 0;
+    while (length > WORD_SIZE) {
+        a = *(const uword_u *) m1;
+        b = *(const uword_u *) m2;
+
+        if (a != b) {
+            return byte_diff(a, b, a ^ b);
+        }
+
+        m1 += WORD_SIZE;
+        m2 += WORD_SIZE;
+        length -= WORD_SIZE;
+    }
+
+    /* last word overlaps bytes which are already known to be equal */
+    a = *(const uword_u *) (m1 + length - WORD_SIZE);
+    b = *(const uword_u *) (m2 + length - WORD_SIZE);
+    return a != b ? byte_diff(a, b, a ^ b) : 0;
 }
 
-void *memset(void *dest, int value, size_t length) {
-    unsigned char *p = (unsigned char *) dest;
+/*
+ * Fill helpers store whole words of replicated value. Head and tail stores of
+ * short fills overlap, so there is no byte loop.
+ */
+static inline void set_small(unsigned char *d, unsigned long w, size_t length) {
+    unsigned char *e = d + length;
+
+    if (length > 32) {
+        *(uword_u *) d = w;
+        *(uword_u *) (d + 8) = w;
+        *(uword_u *) (d + 16) = w;
+        *(uword_u *) (d + 24) = w;
+        *(uword_u *) (e - 32) = w;
+        *(uword_u *) (e - 24) = w;
+        *(uword_u *) (e - 16) = w;
+        *(uword_u *) (e - 8) = w;
+    } else if (length >= 16) {
+        *(uword_u *) d = w;
+        *(uword_u *) (d + 8) = w;
+        *(uword_u *) (e - 16) = w;
+        *(uword_u *) (e - 8) = w;
+    } else if (length >= 8) {
+        *(uword_u *) d = w;
+        *(uword_u *) (e - 8) = w;
+    } else if (length >= 4) {
+        *(u32_u *) d = (unsigned int) w;
+        *(u32_u *) (e - 4) = (unsigned int) w;
+    } else if (length >= 2) {
+        *(u16_u *) d = (unsigned short) w;
+        *(u16_u *) (e - 2) = (unsigned short) w;
+    } else if (length == 1) {
+        *d = (unsigned char) w;
+    }
+}
+
+/* Fills more than COPY_BLOCK bytes, blocks are stored aligned */
+static void set_large(unsigned char *d, unsigned long w, size_t length) {
+    unsigned char *e = d + length;
+    uword *dw;
+
+    set_small(d, w, COPY_ALIGN);
+    d += COPY_ALIGN - ((size_t) d & (COPY_ALIGN - 1));
+
+    while (e - d > COPY_BLOCK) {
+        dw = (uword *) d;
+        dw[0] = w;
+        dw[1] = w;
+        dw[2] = w;
+        dw[3] = w;
+        dw[4] = w;
+        dw[5] = w;
+        dw[6] = w;
+        dw[7] = w;
+        d += COPY_BLOCK;
+    }
+
+    set_small(d, w, e - d);
+}
+
+static inline void set_range(unsigned char *d, unsigned long w, size_t length) {
+    if (length <= COPY_BLOCK) {
+        set_small(d, w, length);
+    } else {
+        set_large(d, w, length);
+    }
+}
+
+#ifdef __aarch64__
+/* below it stores are as fast as DC ZVA */
+#define ZVA_MIN 256
+
+/* returns DC ZVA block size or 0 if DC ZVA is prohibited */
+static inline size_t zva_block_size(void) {
+    unsigned long dczid;
+
+    __asm__ ("mrs %0, dczid_el0" : "=r" (dczid));
+    return (dczid & 0x10) != 0 ? 0 : 4UL << (dczid & 0xf);
+}
+
+/*
+ * Zeroes whole cache lines with DC ZVA, which doesn't read lines in before
+ * writing them. Unaligned head and tail are stored as usual.
+ */
+static void zero_zva(unsigned char *d, size_t length, size_t block) {
+    unsigned char *e = d + length;
+    unsigned char *p = (unsigned char *) (((size_t) d + block - 1) & ~(block - 1));
+
+    set_range(d, 0, p - d);
 
-    while (length-- > 0) {
-        *p++ = (unsigned char) value;
+    for (; (size_t) (e - p) >= block; p += block) {
+        __asm__ __volatile__ ("dc zva, %0" : : "r" (p) : "memory");
     }
 
+    set_range(p, 0, e - p);
+}
+#endif
+
+static void *scalar_memset(void *dest, int value, size_t length) {
+    unsigned char *d = (unsigned char *) dest;
+    unsigned long w = ONES * (unsigned char) value;
+
+    if (length <= COPY_BLOCK) {
+        set_small(d, w, length);
+        return dest;
+    }
+
+#ifdef __aarch64__
+    if (value == 0 && length >= ZVA_MIN) {
+        size_t block = zva_block_size();
+
+        if (block != 0 && length >= 2 * block) {
+            zero_zva(d, length, block);
+            return dest;
+        }
+    }
+#endif
+
+    set_large(d, w, length);
     return dest;
 }
 
@@ -142,16 +435,21 @@ char *strncat(char *dest, const char *src, size_t length) {
     return dest;
 }
 
-char *strchr(const char *str, int needle) {
-    char *s = (char *) str;
-
-    do {
-        if (*s == (char) needle) {
-            return s;
-        }
-    } while (*s++);
+static char *scalar_strchr(const char *str, int needle) {
+    unsigned long pattern = ONES * (unsigned char) needle;
+    size_t offset = (size_t) str & (WORD_SIZE - 1);
+    const uword *w = (const uword *) (str - offset);
+    unsigned long x = *w | below(offset);
+    unsigned long mask = has_zero(x) | has_zero((x ^ pattern) | below(offset));
+    const char *s;
+
+    while (mask == 0) {
+        x = *++w;
+        mask = has_zero(x) | has_zero(x ^ pattern);
+    }
 
-    return NULL;
+    s = (const char *) w + first_byte(mask);
+    return *s == (char) needle ? (char *) s : NULL;
 }
 
 char *strrchr(const char *str, int needle) {
@@ -168,32 +466,11 @@ char *strrchr(const char *str, int needle) {
 }
 
 int strcmp(const char *first, const char *second) {
-    char *f = (char *) first;
-    char *s = (char *) second;
-
-    do {
-        if (*f != *s) {
-            return *f - *s;
-        }
-    } while (*f++ && *s++);
-
-    return 0;
+    return compare_strings((const unsigned char *) first, (const unsigned char *) second, (size_t) -1, 0);
 }
 
 int strncmp(const char *first, const char *second, size_t length) {
-    size_t i = 0;
-
-    for (i = 0; i < length; i++) {
-        if (first[i] != second[i]) {
-            return first[i] - second[i];
-        }
-
-        if (first[i] == '\0' || second[i] == '\0') {
-            break;
-        }
-    }
-
-    return 0;
+    return compare_strings((const unsigned char *) first, (const unsigned char *) second, length, 0);
 }
 
 char *strcpy(char *dest, const char *src) {
@@ -224,88 +501,331 @@ char *strncpy(char *dest, const char *src, size_t n) {
     return dest;
 }
 
-size_t strspn(const char *str, const char *accept) {
-    size_t res = 0;
+/*
+ * Byte sets of strspn() family. Sets of one or two bytes are matched a word at
+ * a time, bigger sets are looked up in a 256 bit map which is built once.
+ */
+#define SET_WORD_BITS (8 * WORD_SIZE)
 
-    while (*str) {
-        if (strchr(accept, *str++) != NULL) {
-            res++;
-        } else {
-            break;
-        }
+struct byte_set {
+    unsigned long map[256 / SET_WORD_BITS];
+    unsigned long first;  /* pattern of the first byte */
+    unsigned long second; /* pattern of the second byte, first if there is one */
+    size_t size;          /* 0, 1, 2 or 3 for bigger sets */
+};
+
+static void byte_set_init(struct byte_set *set, const char *bytes) {
+    const unsigned char *b = (const unsigned char *) bytes;
+    size_t i;
+
+    if (b[0] == '\0' || b[1] == '\0' || b[2] == '\0') {
+        set->size = b[0] == '\0' ? 0 : b[1] == '\0' ? 1 : 2;
+        set->first = ONES * b[0];
+        set->second = set->size == 2 ? ONES * b[1] : set->first;
+        return;
     }
 
-    return res;
+    set->size = 3;
+
+    for (i = 0; i < sizeof(set->map) / sizeof(set->map[0]); i++) {
+        set->map[i] = 0;
+    }
+
+    for (; *b; b++) {
+        set->map[*b / SET_WORD_BITS] |= 1UL << (*b % SET_WORD_BITS);
+    }
 }
 
-size_t strlen(const char *str) {
-    size_t res = 0;
+static inline int byte_set_has(const struct byte_set *set, unsigned char c) {
+    return (set->map[c / SET_WORD_BITS] >> (c % SET_WORD_BITS)) & 1;
+}
 
-    while (*str++ != '\0') {
-        res++;
+/*
+ * Has 0x80 in bytes of w where span stops, bytes covered by head are skipped.
+ * Accepting span needs exact matches since it stops on a mismatch.
+ */
+static inline unsigned long span_stops(const struct byte_set *set, unsigned long w,
+                                       unsigned long head, int reject) {
+    if (reject) {
+        return has_zero(w | head) | has_zero((w ^ set->first) | head)
+            | has_zero((w ^ set->second) | head);
     }
 
-    return res;
+    return ~(zero_bytes(w ^ set->first) | zero_bytes(w ^ set->second) | head) & HIGHS;
 }
 
-size_t strnlen(const char *str, size_t max_len)
-{
-    size_t res = 0;
+/* length of initial segment of str made of bytes in set, or not in set if reject */
+static size_t byte_set_span(const char *str, const struct byte_set *set, int reject) {
+    const unsigned char *s = (const unsigned char *) str;
 
-    if (max_len == 0) {
-        return 0;
+    if (set->size == 0) {
+        return reject ? strlen(str) : 0;
+    } else if (set->size < 3) {
+        size_t offset = (size_t) s & (WORD_SIZE - 1);
+        const uword *w = (const uword *) (s - offset);
+        unsigned long mask = span_stops(set, *w, below(offset), reject);
+
+        while (mask == 0) {
+            mask = span_stops(set, *++w, 0, reject);
+        }
+
+        return (const unsigned char *) w + first_byte(mask) - s;
     }
 
-    while (*str++ != '\0' && max_len -- > 0) {
-        res++;
+    if (reject) {
+        while (*s && !byte_set_has(set, *s)) {
+            s++;
+        }
+    } else {
+        while (byte_set_has(set, *s)) {
+            s++;
+        }
     }
 
-    return res;
+    return (const char *) s - str;
+}
+
+size_t strspn(const char *str, const char *accept) {
+    struct byte_set set;
+
+    byte_set_init(&set, accept);
+    return byte_set_span(str, &set, 0);
+}
+
+static size_t scalar_strlen(const char *str) {
+    size_t offset = (size_t) str & (WORD_SIZE - 1);
+    const uword *w = (const uword *) (str - offset);
+    unsigned long mask = has_zero(*w | below(offset));
+
+    while (mask == 0) {
+        mask = has_zero(*++w);
+    }
+
+    return (const char *) w + first_byte(mask) - str;
+}
+
+size_t strnlen(const char *str, size_t max_len) {
+    const char *end = (const char *) memchr(str, '\0', max_len);
+
+    return end != NULL ? (size_t) (end - str) : max_len;
 }
 
 size_t strcspn(const char *str, const char *reject) {
-    const char *s = str;
-    size_t res = 0;
+    struct byte_set set;
 
-    while (*s) {
-        if (strchr(reject, *s++) == NULL) {
-            res++;
+    byte_set_init(&set, reject);
+    return byte_set_span(str, &set, 1);
+}
+
+char *strpbrk(const char *str, const char *accept) {
+    struct byte_set set;
+
+    byte_set_init(&set, accept);
+    str += byte_set_span(str, &set, 1);
+    return *str ? (char *) str : NULL;
+}
+
+/*
+ * Substring search. Haystack either has known end or is NUL terminated, then
+ * end is discovered lazily so haystack is never scanned twice.
+ */
+
+/* Needles up to a word long are compared with a window of last haystack bytes */
+static const unsigned char *search_short(const unsigned char *h, const unsigned char *end,
+                                         const unsigned char *n, size_t l) {
+    unsigned long mask = l == WORD_SIZE ? ~0UL : (1UL << (8 * l)) - 1;
+    unsigned long needle = 0;
+    unsigned long window = 0;
+    size_t i;
+
+    for (i = 0; i < l; i++) {
+        needle = needle << 8 | n[i];
+    }
+
+    /* window must be full, needle of memmem may start with zero bytes */
+    for (i = 0; i < l - 1; i++, h++) {
+        if (end != NULL ? h >= end : *h == '\0') {
+            return NULL;
+        }
+
+        window = window << 8 | *h;
+    }
+
+    for (; end != NULL ? h < end : *h != '\0'; h++) {
+        window = (window << 8 | *h) & mask;
+
+        if (window == needle) {
+            return h - (l - 1);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns position of the last byte before maximal suffix of needle under
+ * byte order or its reverse, (size_t) -1 if suffix is the whole needle
+ */
+static size_t max_suffix(const unsigned char *n, size_t l, int reverse, size_t *period) {
+    size_t i = (size_t) -1;
+    size_t j = 0;
+    size_t k = 1;
+    size_t p = 1;
+
+    while (j + k < l) {
+        unsigned char a = n[i + k];
+        unsigned char b = n[j + k];
+
+        if (a == b) {
+            if (k == p) {
+                j += p;
+                k = 1;
+            } else {
+                k++;
+            }
+        } else if ((a > b) != reverse) {
+            j += k;
+            k = 1;
+            p = j - i;
         } else {
-            break;
+            i = j++;
+            k = p = 1;
         }
     }
 
-    return res;
+    *period = p;
+    return i;
 }
 
-char *strpbrk(const char *str, const char *accept) {
-    char *s = (char *) str;
+/*
+ * Two-Way search of Crochemore and Perrin, linear time and constant space.
+ * Needle is split by critical factorization at ms, right part is compared
+ * forward and left part backward. Memory of matched prefix avoids rescans
+ * when needle is periodic. Shift by the last byte of window skips ahead
+ * like Horspool.
+ */
+static const unsigned char *search_two_way(const unsigned char *h, const unsigned char *end,
+                                           const unsigned char *n, size_t l) {
+    unsigned char shift[256];
+    const unsigned char *known = h;
+    size_t ms, ms2, p, p2, mem0, k, i;
+    size_t mem = 0;
+
+    /* distance from the last occurrence of byte to the end of needle */
+    memset(shift, l < 255 ? l : 255, sizeof(shift));
+
+    for (i = 0; i < l; i++) {
+        shift[n[i]] = l - 1 - i < 255 ? l - 1 - i : 255;
+    }
 
-    while (*s) {
-        if (strchr(accept, *s++) != NULL) {
-            return --s;
+    ms = max_suffix(n, l, 0, &p);
+    ms2 = max_suffix(n, l, 1, &p2);
+
+    if (ms2 + 1 > ms + 1) {
+        ms = ms2;
+        p = p2;
+    }
+
+    if (memcmp(n, n + p, ms + 1) == 0) {
+        mem0 = l - p;
+    } else {
+        /* not periodic, any window mismatch allows this shift */
+        mem0 = 0;
+        p = (ms + 1 > l - ms - 1 ? ms + 1 : l - ms - 1) + 1;
+    }
+
+    for (;;) {
+        if (end != NULL) {
+            if ((size_t) (end - h) < l) {
+                return NULL;
+            }
+        } else if ((size_t) (known - h) < l) {
+            /* look for terminator a bit further than needed */
+            size_t grow = l | 63;
+            const unsigned char *z = (const unsigned char *) memchr(known, '\0', grow);
+
+            if (z != NULL) {
+                end = z;
+                continue;
+            }
+
+            known += grow;
         }
+
+        k = shift[h[l - 1]];
+
+        if (k != 0) {
+            h += k < mem ? mem : k;
+            mem = 0;
+            continue;
+        }
+
+        for (k = ms + 1 > mem ? ms + 1 : mem; k < l && n[k] == h[k]; k++) {}
+
+        if (k < l) {
+            h += k - ms;
+            mem = 0;
+            continue;
+        }
+
+        for (k = ms + 1; k > mem && n[k - 1] == h[k - 1]; k--) {}
+
+        if (k <= mem) {
+            return h;
+        }
+
+        h += p;
+        mem = mem0;
     }
+}
 
-    return NULL;
+/* end is NULL for NUL terminated haystack, h points to match of n[0] */
+static const unsigned char *search(const unsigned char *h, const unsigned char *end,
+                                   const unsigned char *n, size_t l) {
+    if (l <= WORD_SIZE) {
+        return search_short(h, end, n, l);
+    }
+
+    return search_two_way(h, end, n, l);
 }
 
 char *strstr(const char *haystack, const char *needle) {
-    size_t needle_len = strlen(needle);
-    size_t haystack_len = strlen(haystack);
-    size_t i = 0;
+    const unsigned char *n = (const unsigned char *) needle;
+    const unsigned char *h;
 
-    if (!needle_len && !haystack_len) {
+    if (n[0] == '\0') {
         return (char *) haystack;
     }
 
-    for (i = haystack_len; i >= needle_len; i--, haystack++) {
-        if (strncmp(haystack, needle, needle_len) == 0) {
-            return (char *) haystack;
-        }
+    h = (const unsigned char *) strchr(haystack, n[0]);
+
+    if (h == NULL || n[1] == '\0') {
+        return (char *) h;
     }
 
-    return NULL;
+    return (char *) search(h, NULL, n, strlen(needle));
+}
+
+void *memmem(const void *haystack, size_t haystack_len, const void *needle, size_t needle_len) {
+    const unsigned char *n = (const unsigned char *) needle;
+    const unsigned char *end = (const unsigned char *) haystack + haystack_len;
+    const unsigned char *h;
+
+    if (needle_len == 0) {
+        return (void *) haystack;
+    }
+
+    if (needle_len > haystack_len) {
+        return NULL;
+    }
+
+    h = (const unsigned char *) memchr(haystack, n[0], haystack_len - needle_len + 1);
+
+    if (h == NULL || needle_len == 1) {
+        return (void *) h;
+    }
+
+    return (void *) search(h, end, n, needle_len);
 }
 
 char *strtok(char *str, const char *delim) {
@@ -317,6 +837,7 @@ char *strtok_r(char *str, const char *delim,
                char **saveptr) {
     char *old_str = saveptr ? *saveptr : NULL;
     char *res = NULL;
+    struct byte_set set;
 
     if (!str) {
         if (!old_str) {
@@ -326,14 +847,15 @@ char *strtok_r(char *str, const char *delim,
         old_str = str;
     }
 
-    old_str += strspn(old_str, delim);
+    byte_set_init(&set, delim);
+    old_str += byte_set_span(old_str, &set, 0);
 
     if (*old_str == '\0') {
         return NULL;
     }
 
     res = old_str++;
-    old_str += strcspn(old_str, delim);
+    old_str += byte_set_span(old_str, &set, 1);
 
     if (*old_str != '\0') {
         *old_str++ = '\0';
@@ -375,26 +897,39 @@ char *strrev(char *str) {
     return str;
 }
 
-char *strupr(char *str) {
-    char *p = str;
+/* converts case in place, words are converted until the one with terminator */
+static char *convert_case(char *str, int upper) {
+    unsigned char *p = (unsigned char *) str;
+    unsigned long w;
 
-    do {
-        *p = islower(*p) ? toupper(*p) : *p;
-    } while (*p++ != '\0');
+    for (; ((size_t) p & (WORD_SIZE - 1)) != 0; p++) {
+        if (*p == '\0') {
+            return str;
+        }
 
-    return str;
-}
+        *p = upper ? toupper(*p) : tolower(*p);
+    }
 
-char *strlwr(char *str) {
-    char *p = str;
+    while (has_zero(w = *(uword *) p) == 0) {
+        *(uword *) p = upper ? fold_upper(w) : fold_lower(w);
+        p += WORD_SIZE;
+    }
 
-    do {
-        *p = isupper(*p) ? tolower(*p) : *p;
-    } while (*p++ != '\0');
+    for (; *p != '\0'; p++) {
+        *p = upper ? toupper(*p) : tolower(*p);
+    }
 
     return str;
 }
 
+char *strupr(char *str) {
+    return convert_case(str, 1);
+}
+
+char *strlwr(char *str) {
+    return convert_case(str, 0);
+}
+
 void *mempcpy(void *dest, const void *src, size_t n) {
     return memcpy(dest, src, n) + n;
 }
@@ -409,4 +944,135 @@ char *stpncpy(char *dest, const char *src, size_t count) {
     size_t len = strnlen(src, count);
     dest = memcpy(dest, src, len) + len;
     return count > len ? memset(dest, '\0', count - len) : dest;
-}
\ No newline at end of file
+}
+
+/*
+ * Dispatch. sStringOps points to scalar routines from the start, so string
+ * functions work before string_dispatch_init(). Switching variant is a single
+ * pointer store.
+ */
+struct string_ops {
+    enum string_variant variant;
+    void *(*memcpy)(void *__restrict__ dest, const void *__restrict__ src, size_t length);
+    void *(*memmove)(void *dest, const void *src, size_t length);
+    void *(*memset)(void *dest, int value, size_t length);
+    int (*memcmp)(const void *first, const void *second, size_t length);
+    void *(*memchr)(const void *memory, int needle, size_t count);
+    size_t (*strlen)(const char *str);
+    char *(*strchr)(const char *str, int needle);
+};
+
+static const struct string_ops sScalarOps = {
+    STRING_VARIANT_SCALAR,
+    scalar_memcpy,
+    scalar_memmove,
+    scalar_memset,
+    scalar_memcmp,
+    scalar_memchr,
+    scalar_strlen,
+    scalar_strchr,
+};
+
+#ifdef LIBC_SIMD
+/* vector memmove would have to deal with overlap, scalar one is kept */
+static const struct string_ops sSimdOps = {
+    STRING_VARIANT_SIMD,
+    simd_memcpy,
+    scalar_memmove,
+    simd_memset,
+    simd_memcmp,
+    simd_memchr,
+    simd_strlen,
+    simd_strchr,
+};
+#endif
+
+/* the best variant goes first */
+static const struct string_ops *const sStringVariants[] = {
+#ifdef LIBC_SIMD
+    &sSimdOps,
+#endif
+    &sScalarOps,
+};
+
+static const struct string_ops *sStringOps = &sScalarOps;
+
+static int cpu_has_simd(void) {
+#if defined(__aarch64__)
+    unsigned long pfr0;
+
+    __asm__ ("mrs %0, id_aa64pfr0_el1" : "=r" (pfr0));
+    /* AdvSIMD field is 0xf when not implemented */
+    return ((pfr0 >> 20) & 0xf) != 0xf;
+#elif defined(__x86_64__) /* Testing only */
+    unsigned int eax = 1;
+    unsigned int ebx;
+    unsigned int ecx = 0;
+    unsigned int edx;
+
+    __asm__ ("cpuid" : "+a" (eax), "=b" (ebx), "+c" (ecx), "=d" (edx));
+    /* SSE2 */
+    return (edx >> 26) & 1;
+#else
+    return 0;
+#endif
+}
+
+static int cpu_supports(enum string_variant variant) {
+    return variant == STRING_VARIANT_SIMD ? cpu_has_simd() : 1;
+}
+
+void string_dispatch_init(void) {
+    string_dispatch_force(STRING_VARIANT_AUTO);
+}
+
+int string_dispatch_force(enum string_variant variant) {
+    size_t i;
+
+    if ((unsigned) variant > STRING_VARIANT_SIMD) {
+        return EINVAL;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(sStringVariants); i++) {
+        const struct string_ops *ops = sStringVariants[i];
+
+        if ((variant == STRING_VARIANT_AUTO || variant == ops->variant) && cpu_supports(ops->variant)) {
+            sStringOps = ops;
+            return 0;
+        }
+    }
+
+    return ENOSYS;
+}
+
+enum string_variant string_dispatch_variant(void) {
+    return sStringOps->variant;
+}
+
+void *memcpy(void *__restrict__ dest, const void *__restrict__ src, size_t length) {
+    return sStringOps->memcpy(dest, src, length);
+}
+
+void *memmove(void *dest, const void *src, size_t length) {
+    return sStringOps->memmove(dest, src, length);
+}
+
+void *memset(void *dest, int value, size_t length) {
+    return sStringOps->memset(dest, value, length);
+}
+
+int memcmp(const void *first, const void *second, size_t length) {
+    return sStringOps->memcmp(first, second, length);
+}
+
+void *memchr(const void *memory, int needle, size_t count) {
+    return sStringOps->memchr(memory, needle, count);
+}
+
+size_t strlen(const char *str) {
+    return sStringOps->strlen(str);
+}
+
+char *strchr(const char *str, int needle) {
+    return sStringOps->strchr(str, needle);
+}
@@ -0,0 +1,163 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Dmitry Adzhiev <dmitry.adjiev@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Word-at-a-time helpers shared by string.c and strings.c
+ */
+
+#ifndef MACONDOOS_LIB_LIBC_COMMON_STRING_STRING_WORD_H_
+#define MACONDOOS_LIB_LIBC_COMMON_STRING_STRING_WORD_H_
+
+#include <stddef.h>
+#include <asm/page.h>
+
+/*
+ * Word access types. Unaligned accesses go through may_alias types with
+ * alignment 1, so compiler emits plain loads and stores and never turns them
+ * back into memcpy() calls.
+ */
+typedef unsigned long __attribute__((__may_alias__)) uword;
+typedef unsigned long __attribute__((__may_alias__, __aligned__(1))) uword_u;
+
+/*
+ * Word-at-a-time scanning. Loads are aligned, so a word never crosses a page
+ * boundary and reading bytes around the range can't fault. Bytes outside the
+ * range are forced to non zero before testing. Words are little endian, the
+ * lowest set bit of has_zero() is always an exact match, the higher ones may
+ * be false positives caused by borrow.
+ */
+#define WORD_SIZE sizeof(unsigned long)
+#define ONES      (~0UL / 0xff)
+#define HIGHS     (ONES * 0x80)
+
+static inline unsigned long has_zero(unsigned long x) {
+    return (x - ONES) & ~x & HIGHS;
+}
+
+/* has 0x80 in every zero byte and nothing else, needed to scan backwards */
+static inline unsigned long zero_bytes(unsigned long x) {
+    return ~(((x & ~HIGHS) + ~HIGHS) | x | ~HIGHS);
+}
+
+/* non zero bytes in place of the first offset bytes of a word */
+static inline unsigned long below(size_t offset) {
+    return (1UL << (offset * 8)) - 1;
+}
+
+static inline size_t first_byte(unsigned long mask) {
+    return __builtin_ctzl(mask) / 8;
+}
+
+static inline size_t last_byte(unsigned long mask) {
+    return (WORD_SIZE * 8 - 1 - __builtin_clzl(mask)) / 8;
+}
+
+/* difference of the first bytes of a and b marked in mask */
+static inline int byte_diff(unsigned long a, unsigned long b, unsigned long mask) {
+    size_t shift = first_byte(mask) * 8;
+
+    return (int) ((a >> shift) & 0xff) - (int) ((b >> shift) & 0xff);
+}
+
+/*
+ * ASCII case conversion of all bytes of a word. Adding to the low 7 bits of a
+ * byte sets its top bit when the byte is at or above a bound and never carries
+ * into the next byte, bytes with top bit set are not letters and are kept.
+ */
+static inline unsigned long in_range(unsigned long x, unsigned char first, unsigned char last) {
+    unsigned long low = x & ~HIGHS;
+
+    return (low + ONES * (0x80 - first)) & ~(low + ONES * (0x80 - last - 1)) & ~x & HIGHS;
+}
+
+/* 0x80 >> 2 is the bit which differs between upper and lower case letters */
+static inline unsigned long fold_lower(unsigned long x) {
+    return x | (in_range(x, 'A', 'Z') >> 2);
+}
+
+static inline unsigned long fold_upper(unsigned long x) {
+    return x & ~(in_range(x, 'a', 'z') >> 2);
+}
+
+static inline int fold_byte(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+/* unaligned word at s would touch the next page, which may be unmapped */
+static inline int crosses_page(const unsigned char *s) {
+    return ((size_t) s & (PAGE_SIZE - 1)) > PAGE_SIZE - WORD_SIZE;
+}
+
+/*
+ * Compares up to length bytes of strings, ignoring case if fold is set. Loads
+ * from first are aligned so they never run past its terminator into another
+ * page, words of second which straddle a page are compared byte by byte.
+ */
+static inline int compare_strings(const unsigned char *f, const unsigned char *s, size_t length,
+                                  int fold) {
+    size_t chunk = -(size_t) f & (WORD_SIZE - 1);
+
+    for (;;) {
+        chunk = chunk < length ? chunk : length;
+        length -= chunk;
+
+        for (; chunk > 0; chunk--, f++, s++) {
+            int a = fold ? fold_byte(*f) : *f;
+            int b = fold ? fold_byte(*s) : *s;
+
+            if (a != b || a == '\0') {
+                return a - b;
+            }
+        }
+
+        while (length >= WORD_SIZE && !crosses_page(s)) {
+            unsigned long a = *(const uword *) f;
+            unsigned long b = *(const uword_u *) s;
+
+            if (fold) {
+                a = fold_lower(a);
+                b = fold_lower(b);
+            }
+
+            /* has_zero() false positives are only above a real zero byte */
+            unsigned long mask = (a ^ b) | has_zero(a);
+
+            if (mask != 0) {
+                return byte_diff(a, b, mask);
+            }
+
+            f += WORD_SIZE;
+            s += WORD_SIZE;
+            length -= WORD_SIZE;
+        }
+
+        if (length == 0) {
+            return 0;
+        }
+
+        chunk = WORD_SIZE;
+    }
+}
+
+#endif //MACONDOOS_LIB_LIBC_COMMON_STRING_STRING_WORD_H_
@@ -25,6 +25,7 @@
 #include <strings.h>
 #include <string.h>
 #include <ctype.h>
+#include "string_word.h"
 
 size_t strlcpy(char *__restrict__ dst, const char *__restrict__ src, size_t size) {
     size_t len = strlen(src);
@@ -66,28 +67,32 @@ size_t strlcat(char *__restrict__ dst, const char *__restrict__ src, size_t dsts
 }
 
 int strcasecmp(const char *first, const char *second) {
-    char *f = (char *) first;
-    char *s = (char *) second;
-
-    do {
-        if (tolower(*f) != tolower(*s)) {
-            return tolower(*f) - tolower(*s);
-        }
-    } while (*f++ && *s++);
-
-    return 0;
+    return compare_strings((const unsigned char *) first, (const unsigned char *) second, (size_t) -1, 1);
 }
 
 int strncasecmp(const char *first, const char *second, size_t n) {
-    size_t i = 0;
+    return compare_strings((const unsigned char *) first, (const unsigned char *) second, n, 1);
+}
+
+int memcasecmp(const void *first, const void *second, size_t length) {
+    const unsigned char *m1 = (const unsigned char *) first;
+    const unsigned char *m2 = (const unsigned char *) second;
 
-    for (i = 0; i < n; i++) {
-        if (tolower(first[i]) != tolower(second[i])) {
-            return tolower(first[i]) - tolower(second[i]);
+    for (; length >= WORD_SIZE; length -= WORD_SIZE) {
+        unsigned long a = fold_lower(*(const uword_u *) m1);
+        unsigned long b = fold_lower(*(const uword_u *) m2);
+
+        if (a != b) {
+            return byte_diff(a, b, a ^ b);
         }
 
-        if (first[i] == '\0' || second[i] == '\0') {
-            break;
+        m1 += WORD_SIZE;
+        m2 += WORD_SIZE;
+    }
+
+    for (; length > 0; length--, m1++, m2++) {
+        if (fold_byte(*m1) != fold_byte(*m2)) {
+            return fold_byte(*m1) - fold_byte(*m2);
         }
     }
 
@@ -95,37 +100,25 @@ int strncasecmp(const char *first, const char *second, size_t n) {
 }
 
 int ffs(int val) {
-    int i = 0;
-
-    if (val != 0) {
-        for (i = 1; !(val & 1); i++){
-            val = (unsigned int) val >> 1;
-        }
-    }
-
-    return i;
+    return val != 0 ? __builtin_ctz((unsigned int) val) + 1 : 0;
 }
 
 int ffsl(long int val) {
-    int i = 0;
-
-    if (val != 0) {
-        for (i = 1; !(val & 1); i++){
-            val = (unsigned long int) val >> 1;
-        }
-    }
-
-    return i;
+    return val != 0 ? __builtin_ctzl((unsigned long int) val) + 1 : 0;
 }
 
 int ffsll(long long int val) {
-    int i =0;
+    return val != 0 ? __builtin_ctzll((unsigned long long int) val) + 1 : 0;
+}
 
-    if (val != 0) {
-        for (i = 1; !(val & 1); i++){
-            val = (unsigned long long int) val >> 1;
-        }
-    }
+int fls(int val) {
+    return val != 0 ? (int) (sizeof(val) * 8) - __builtin_clz((unsigned int) val) : 0;
+}
 
-    return i;
-}
\ No newline at end of file
+int flsl(long int val) {
+    return val != 0 ? (int) (sizeof(val) * 8) - __builtin_clzl((unsigned long int) val) : 0;
+}
+
+int flsll(long long int val) {
+    return val != 0 ? (int) (sizeof(val) * 8) - __builtin_clzll((unsigned long long int) val) : 0;
+}
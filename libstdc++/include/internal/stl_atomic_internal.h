@@ -75,12 +75,12 @@ public:
 
     _Type exchange(_Type __desired, memory_order __order = memory_order::memory_order_seq_cst) noexcept
     {
-        return ATOMIC_BUILTIN(_exchange)(addressof(_M_value), __desired, __order);
+        return ATOMIC_BUILTIN(exchange)(addressof(_M_value), __desired, __order);
     }
 
     _Type exchange(_Type __desired, memory_order __order = memory_order::memory_order_seq_cst) volatile noexcept
     {
-        return ATOMIC_BUILTIN(_exchange)(addressof(_M_value), __desired, __order);
+        return ATOMIC_BUILTIN(exchange)(addressof(_M_value), __desired, __order);
     }
 
     void store(_Type __desired, memory_order __order = memory_order::memory_order_seq_cst) noexcept
@@ -0,0 +1,428 @@
+#include "bench.h"
+#include "../../include/stdlib.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Replays allocation traces against mem_malloc/mem_free/mem_realloc and
+ * reports throughput, peak footprint and fragmentation, so allocator backends
+ * can be compared on identical workloads.
+ *
+ * usage: alloc_replay [-H heap_mib] [trace...]
+ *
+ * Trace is text in mem_trace_dump() format, one record per line:
+ *     <timestamp> <op> <size> <alignment> <ptr> <old_ptr>
+ * Anything up to the last tab is ignored, so captured log lines with
+ * "Malloc:\t" prefix can be replayed as is. Without traces a few synthetic
+ * workloads are replayed.
+ */
+
+using namespace std::chrono;
+
+static constexpr double kMinTimeSec = 0.2;
+/* stats are sampled every kSampleInterval ops during analysis pass */
+static constexpr size_t kSampleInterval = 256;
+
+struct Op {
+    int op;
+    size_t size;
+    size_t alignment;
+    size_t slot;
+};
+
+/* trace converted to slot indexes so replay doesn't spend time on lookups */
+struct Replay {
+    std::string name;
+    std::vector<Op> ops;
+    size_t slots = 0;
+    size_t peak_requested = 0;
+};
+
+struct Result {
+    double ops_per_sec = 0;
+    struct mem_stats stats = {};
+    /* sampled when most of heap is in use */
+    double peak_fragmentation = 0;
+    double max_fragmentation = 0;
+};
+
+static Replay convert(const std::string &name, const std::vector<struct mem_trace_record> &records) {
+    Replay replay;
+    std::unordered_map<size_t, size_t> live;
+    std::vector<size_t> free_slots;
+    std::vector<size_t> requested;
+    size_t requested_total = 0;
+
+    replay.name = name;
+
+    auto take_slot = [&]() {
+        if (!free_slots.empty()) {
+            size_t slot = free_slots.back();
+            free_slots.pop_back();
+            return slot;
+        }
+
+        requested.push_back(0);
+        return replay.slots++;
+    };
+
+    for (const struct mem_trace_record &rec: records) {
+        switch (rec.op) {
+            case MEM_TRACE_MALLOC:
+            case MEM_TRACE_ALIGNED_ALLOC: {
+                size_t slot = take_slot();
+                replay.ops.push_back({rec.op, rec.size, rec.alignment, slot});
+
+                if (rec.ptr != 0) {
+                    live[rec.ptr] = slot;
+                    requested[slot] = rec.size;
+                    requested_total += rec.size;
+                }
+                else {
+                    /* failed while recording, replay it but don't track */
+                    replay.ops.push_back({MEM_TRACE_FREE, 0, 0, slot});
+                    free_slots.push_back(slot);
+                }
+
+                break;
+            }
+            case MEM_TRACE_FREE: {
+                auto it = live.find(rec.ptr);
+
+                if (it != live.end()) {
+                    replay.ops.push_back({rec.op, 0, 0, it->second});
+                    requested_total -= requested[it->second];
+                    free_slots.push_back(it->second);
+                    live.erase(it);
+                }
+
+                break;
+            }
+            case MEM_TRACE_REALLOC: {
+                auto it = live.find(rec.old_ptr);
+
+                if (it != live.end()) {
+                    size_t slot = it->second;
+                    replay.ops.push_back({rec.op, rec.size, 0, slot});
+
+                    if (rec.ptr != 0) {
+                        live.erase(it);
+                        live[rec.ptr] = slot;
+                        requested_total += rec.size - requested[slot];
+                        requested[slot] = rec.size;
+                    }
+                }
+
+                break;
+            }
+            default:
+                break;
+        }
+
+        if (requested_total > replay.peak_requested) {
+            replay.peak_requested = requested_total;
+        }
+    }
+
+    return replay;
+}
+
+static bool load(const char *path, std::vector<struct mem_trace_record> &records) {
+    FILE *file = fopen(path, "r");
+    char line[512];
+
+    if (file == nullptr) {
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        const char *text = strrchr(line, '\t');
+        struct mem_trace_record rec = {};
+        char op = 0;
+
+        text = text != nullptr ? text + 1 : line;
+
+        if (sscanf(text, "%llu %c %zu %zu %zx %zx", &rec.timestamp, &op, &rec.size,
+                   &rec.alignment, &rec.ptr, &rec.old_ptr) == 6) {
+            rec.op = op;
+            records.push_back(rec);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+static inline void execute(const Op &op, std::vector<void *> &slots) {
+    void *&ptr = slots[op.slot];
+
+    switch (op.op) {
+        case MEM_TRACE_MALLOC:
+            ptr = mem_malloc(op.size);
+            break;
+        case MEM_TRACE_ALIGNED_ALLOC:
+            ptr = mem_aligned_alloc(op.alignment, op.size);
+            break;
+        case MEM_TRACE_FREE:
+            if (ptr != nullptr) {
+                mem_free(ptr);
+                ptr = nullptr;
+            }
+            break;
+        case MEM_TRACE_REALLOC:
+            if (ptr != nullptr) {
+                void *blk = mem_realloc(ptr, op.size);
+                ptr = blk != nullptr ? blk : ptr;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static double fragmentation(const struct mem_stats &stats) {
+    return stats.bytes_free == 0 ? 0 : 1.0 - static_cast<double>(stats.largest_free_block) / stats.bytes_free;
+}
+
+static Result run(const Replay &replay, char *heap, size_t heap_size) {
+    Result result;
+    std::vector<void *> slots(replay.slots);
+    size_t total_ops = 0;
+    double elapsed = 0;
+
+    while (elapsed < kMinTimeSec || total_ops == 0) {
+        mem_init(heap, heap_size);
+        std::fill(slots.begin(), slots.end(), nullptr);
+
+        auto start = steady_clock::now();
+
+        for (const Op &op: replay.ops) {
+            execute(op, slots);
+        }
+
+        bench::clobber_memory();
+        elapsed += duration<double>(steady_clock::now() - start).count();
+        total_ops += replay.ops.size();
+
+        if (replay.ops.empty()) {
+            break;
+        }
+    }
+
+    result.ops_per_sec = elapsed > 0 ? total_ops / elapsed : 0;
+
+    /* untimed pass which samples heap state */
+    mem_init(heap, heap_size);
+    std::fill(slots.begin(), slots.end(), nullptr);
+    size_t peak_in_use = 0;
+
+    for (size_t i = 0; i < replay.ops.size(); i++) {
+        execute(replay.ops[i], slots);
+
+        if (i % kSampleInterval == 0) {
+            struct mem_stats stats;
+            mem_get_stats(&stats);
+
+            if (stats.bytes_in_use >= peak_in_use) {
+                peak_in_use = stats.bytes_in_use;
+                result.peak_fragmentation = fragmentation(stats);
+            }
+
+            if (fragmentation(stats) > result.max_fragmentation) {
+                result.max_fragmentation = fragmentation(stats);
+            }
+        }
+    }
+
+    mem_get_stats(&result.stats);
+    return result;
+}
+
+/* xorshift, synthetic traces must be the same on every run */
+static uint64_t next_random(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/* log-uniform size in [min, max) */
+static size_t random_size(uint64_t &state, size_t min, size_t max) {
+    int min_log = 63 - __builtin_clzll(min);
+    int max_log = 63 - __builtin_clzll(max);
+    int bits = min_log + static_cast<int>(next_random(state) % (max_log - min_log));
+    return (1UL << bits) + next_random(state) % (1UL << bits);
+}
+
+class Recorder {
+public:
+    size_t malloc(size_t size) {
+        return push(MEM_TRACE_MALLOC, size, 0, 0);
+    }
+
+    void free(size_t ptr) {
+        push(MEM_TRACE_FREE, 0, ptr, 0);
+    }
+
+    size_t realloc(size_t ptr, size_t size) {
+        return push(MEM_TRACE_REALLOC, size, 0, ptr);
+    }
+
+    const std::vector<struct mem_trace_record> &records() const {
+        return records_;
+    }
+
+private:
+    size_t push(int op, size_t size, size_t ptr, size_t old_ptr) {
+        struct mem_trace_record rec = {};
+        rec.timestamp = records_.size();
+        rec.op = op;
+        rec.size = size;
+        rec.ptr = op == MEM_TRACE_FREE ? ptr : ++last_id_;
+        rec.old_ptr = old_ptr;
+        records_.push_back(rec);
+        return rec.ptr;
+    }
+
+    std::vector<struct mem_trace_record> records_;
+    size_t last_id_ = 0;
+};
+
+/* random mix of small and medium objects with bounded live set */
+static std::vector<struct mem_trace_record> churn_trace() {
+    Recorder recorder;
+    std::vector<size_t> live;
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+    for (int i = 0; i < 200000; i++) {
+        if (live.size() < 4096 && (live.empty() || next_random(state) % 100 < 55)) {
+            live.push_back(recorder.malloc(random_size(state, 16, 4096)));
+        }
+        else {
+            size_t victim = next_random(state) % live.size();
+            recorder.free(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for (size_t ptr: live) {
+        recorder.free(ptr);
+    }
+
+    return recorder.records();
+}
+
+/* growing buffers interleaved with long living small objects */
+static std::vector<struct mem_trace_record> realloc_trace() {
+    Recorder recorder;
+    std::vector<size_t> pins;
+    uint64_t state = 0x2545f4914f6cdd1dULL;
+
+    for (int round = 0; round < 256; round++) {
+        size_t size = 64;
+        size_t buf = recorder.malloc(size);
+
+        while (size < 64 * 1024) {
+            size += random_size(state, 16, 1024);
+            buf = recorder.realloc(buf, size);
+
+            if (next_random(state) % 4 == 0) {
+                pins.push_back(recorder.malloc(random_size(state, 16, 128)));
+            }
+        }
+
+        recorder.free(buf);
+    }
+
+    for (size_t ptr: pins) {
+        recorder.free(ptr);
+    }
+
+    return recorder.records();
+}
+
+/* many small objects, every other one dies, then big objects arrive */
+static std::vector<struct mem_trace_record> phases_trace() {
+    Recorder recorder;
+    std::vector<size_t> small;
+    std::vector<size_t> big;
+    uint64_t state = 0x853c49e6748fea9bULL;
+
+    for (int phase = 0; phase < 8; phase++) {
+        for (int i = 0; i < 8192; i++) {
+            small.push_back(recorder.malloc(random_size(state, 16, 256)));
+        }
+
+        for (size_t i = 0; i < small.size(); i += 2) {
+            recorder.free(small[i]);
+        }
+
+        for (int i = 0; i < 256; i++) {
+            big.push_back(recorder.malloc(random_size(state, 1024, 16384)));
+        }
+
+        for (size_t i = 1; i < small.size(); i += 2) {
+            recorder.free(small[i]);
+        }
+
+        small.clear();
+    }
+
+    for (size_t ptr: big) {
+        recorder.free(ptr);
+    }
+
+    return recorder.records();
+}
+
+int main(int argc, char **argv) {
+    size_t heap_size = 64UL << 20;
+    std::vector<Replay> replays;
+    int arg = 1;
+
+    if (arg + 1 < argc && strcmp(argv[arg], "-H") == 0) {
+        heap_size = strtoul(argv[arg + 1], nullptr, 10) << 20;
+        arg += 2;
+    }
+
+    for (; arg < argc; arg++) {
+        std::vector<struct mem_trace_record> records;
+
+        if (!load(argv[arg], records)) {
+            fprintf(stderr, "Can't read trace %s\n", argv[arg]);
+            return 1;
+        }
+
+        replays.push_back(convert(argv[arg], records));
+    }
+
+    if (replays.empty()) {
+        replays.push_back(convert("synthetic/churn", churn_trace()));
+        replays.push_back(convert("synthetic/realloc", realloc_trace()));
+        replays.push_back(convert("synthetic/phases", phases_trace()));
+    }
+
+    std::unique_ptr<char[]> heap(new char[heap_size]);
+
+    printf("%-32s %10s %12s %14s %14s %12s %10s %9s\n", "trace", "ops", "Mops/s", "peak KiB",
+           "peak live KiB", "peak frag %", "max frag %", "failures");
+
+    for (const Replay &replay: replays) {
+        Result result = run(replay, heap.get(), heap_size);
+        printf("%-32s %10zu %12.2f %14zu %14zu %12.1f %10.1f %9zu\n", replay.name.c_str(),
+               replay.ops.size(), result.ops_per_sec / 1e6,
+               result.stats.peak_bytes_in_use >> 10, replay.peak_requested >> 10,
+               result.peak_fragmentation * 100, result.max_fragmentation * 100,
+               result.stats.failures);
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef MACONDOOS_TEST_BENCH_BENCH_H_
+#define MACONDOOS_TEST_BENCH_BENCH_H_
+
+/*
+ * Tiny self-contained benchmark harness. Benchmark body runs state.iterations
+ * times and harness grows iterations count until run takes long enough to be
+ * measured reliably.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct State {
+    size_t iterations = 1;
+    /* set by benchmark body to get throughput reported */
+    size_t bytes_processed = 0;
+    size_t items_processed = 0;
+};
+
+using Function = std::function<void(State &)>;
+
+struct Benchmark {
+    std::string name;
+    Function function;
+};
+
+inline std::vector<Benchmark> &registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+inline void register_benchmark(const std::string &name, Function function) {
+    registry().push_back({name, std::move(function)});
+}
+
+struct Registrar {
+    Registrar(const char *name, Function function) {
+        register_benchmark(name, std::move(function));
+    }
+};
+
+/* prevents compiler from optimizing value away */
+template<typename T>
+inline void do_not_optimize(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+} // namespace bench
+
+#define BENCH_CONCAT_IMPL(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_IMPL(a, b)
+
+#define BENCHMARK(fn) \
+    static bench::Registrar BENCH_CONCAT(fn##_registrar_, __LINE__)(#fn, fn)
+
+#endif //MACONDOOS_TEST_BENCH_BENCH_H_
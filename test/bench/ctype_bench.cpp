@@ -0,0 +1,102 @@
+#include "bench.h"
+#include "../../include/ctype.h"
+#include <cstdint>
+
+/*
+ * Classification throughput of table driven ctype.h functions, which inline at
+ * call sites, against out of line range comparisons libc used before. Every
+ * iteration classifies kTextSize bytes of mixed text, items/s is characters
+ * per second.
+ */
+
+static constexpr size_t kTextSize = 4096;
+
+namespace libc = __MACONDO_TEST_NAMESPACE;
+
+/* mostly printable ASCII with some control and high bytes, like config text */
+static const unsigned char *text() {
+    static unsigned char buffer[kTextSize];
+    static const bool filled = [] {
+        uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+        for (unsigned char &c: buffer) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            c = state % 8 == 0 ? static_cast<unsigned char>(state >> 8) : 32 + (state >> 8) % 95;
+        }
+
+        return true;
+    }();
+    (void) filled;
+    return buffer;
+}
+
+__attribute__((noinline)) static int ranges_isalnum(int c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+__attribute__((noinline)) static int ranges_ispunct(int c) {
+    return (c >= 33 && c <= 47) || (c >= 58 && c <= 64) || (c >= 91 && c <= 96) || (c >= 123 && c <= 126);
+}
+
+__attribute__((noinline)) static int ranges_isxdigit(int c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+__attribute__((noinline)) static int ranges_isspace(int c) {
+    return (c >= 9 && c <= 13) || c == 32;
+}
+
+__attribute__((noinline)) static int ranges_tolower(int c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+template<typename Classify>
+static void classify(bench::State &state, Classify fn) {
+    const unsigned char *s = text();
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        unsigned sum = 0;
+
+        for (size_t j = 0; j < kTextSize; j++) {
+            sum += fn(s[j]) != 0;
+        }
+
+        bench::do_not_optimize(sum);
+    }
+
+    state.bytes_processed = kTextSize * state.iterations;
+    state.items_processed = kTextSize * state.iterations;
+}
+
+template<typename Convert>
+static void convert(bench::State &state, Convert fn) {
+    const unsigned char *s = text();
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        unsigned sum = 0;
+
+        for (size_t j = 0; j < kTextSize; j++) {
+            sum += fn(s[j]);
+        }
+
+        bench::do_not_optimize(sum);
+    }
+
+    state.bytes_processed = kTextSize * state.iterations;
+    state.items_processed = kTextSize * state.iterations;
+}
+
+static const bench::Registrar sCtypeBenchmarks[] = {
+    {"ctype/isalnum/table", [](bench::State &state) { classify(state, [](int c) { return libc::isalnum(c); }); }},
+    {"ctype/isalnum/ranges", [](bench::State &state) { classify(state, ranges_isalnum); }},
+    {"ctype/ispunct/table", [](bench::State &state) { classify(state, [](int c) { return libc::ispunct(c); }); }},
+    {"ctype/ispunct/ranges", [](bench::State &state) { classify(state, ranges_ispunct); }},
+    {"ctype/isxdigit/table", [](bench::State &state) { classify(state, [](int c) { return libc::isxdigit(c); }); }},
+    {"ctype/isxdigit/ranges", [](bench::State &state) { classify(state, ranges_isxdigit); }},
+    {"ctype/isspace/table", [](bench::State &state) { classify(state, [](int c) { return libc::isspace(c); }); }},
+    {"ctype/isspace/ranges", [](bench::State &state) { classify(state, ranges_isspace); }},
+    {"ctype/tolower/table", [](bench::State &state) { convert(state, [](int c) { return libc::tolower(c); }); }},
+    {"ctype/tolower/ranges", [](bench::State &state) { convert(state, ranges_tolower); }},
+};
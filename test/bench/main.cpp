@@ -0,0 +1,122 @@
+#include "bench.h"
+#include "../../include/macondo/string_dispatch.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace std::chrono;
+
+static constexpr double kMinTimeSec = 0.2;
+
+static double run(const bench::Benchmark &benchmark, bench::State &state) {
+    for (;;) {
+        auto start = steady_clock::now();
+        benchmark.function(state);
+        double elapsed = duration<double>(steady_clock::now() - start).count();
+
+        if (elapsed >= kMinTimeSec || state.iterations >= (1UL << 40)) {
+            return elapsed;
+        }
+
+        /* aim at 1.5 of min time to not rerun once more */
+        double scale = elapsed > 0 ? 1.5 * kMinTimeSec / elapsed : 100;
+        state.iterations = static_cast<size_t>(state.iterations * (scale > 100 ? 100 : scale)) + 1;
+        state.bytes_processed = 0;
+        state.items_processed = 0;
+    }
+}
+
+static bool parse_variant(const char *name, enum string_variant &variant) {
+    static const struct {
+        const char *name;
+        enum string_variant variant;
+    } variants[] = {
+        {"auto", STRING_VARIANT_AUTO},
+        {"scalar", STRING_VARIANT_SCALAR},
+        {"simd", STRING_VARIANT_SIMD},
+    };
+
+    for (const auto &v: variants) {
+        if (strcmp(name, v.name) == 0) {
+            variant = v.variant;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * usage: libc_bench [--json] [--variant auto|scalar|simd] [filter], filter is
+ * a substring of benchmark name. Variant selects string routines, see
+ * string_dispatch_force(). JSON output follows Google Benchmark layout so its
+ * compare tools can be used for regression tracking.
+ */
+int main(int argc, char **argv) {
+    const char *filter = nullptr;
+    const char *variant_name = "auto";
+    enum string_variant variant = STRING_VARIANT_AUTO;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        }
+        else if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc) {
+            variant_name = argv[++i];
+
+            if (!parse_variant(variant_name, variant)) {
+                fprintf(stderr, "Unknown variant %s\n", variant_name);
+                return 1;
+            }
+        }
+        else {
+            filter = argv[i];
+        }
+    }
+
+    if (string_dispatch_force(variant) != 0) {
+        fprintf(stderr, "Variant %s isn't available\n", variant_name);
+        return 1;
+    }
+
+    if (json) {
+        printf("{\n  \"context\": {\"library\": \"macondo libc\"},\n  \"benchmarks\": [");
+    }
+    else {
+        printf("%-48s %14s %12s %14s %14s\n", "benchmark", "iterations", "ns/iter", "MiB/s", "items/s");
+    }
+
+    bool first = true;
+
+    for (const bench::Benchmark &benchmark: bench::registry()) {
+        if (filter != nullptr && strstr(benchmark.name.c_str(), filter) == nullptr) {
+            continue;
+        }
+
+        bench::State state;
+        double elapsed = run(benchmark, state);
+        double ns_per_iter = elapsed * 1e9 / state.iterations;
+
+        if (json) {
+            printf("%s\n    {\"name\": \"%s\", \"run_name\": \"%s\", \"run_type\": \"iteration\", "
+                   "\"iterations\": %zu, \"real_time\": %.3f, \"cpu_time\": %.3f, \"time_unit\": \"ns\", "
+                   "\"bytes_per_second\": %.1f, \"items_per_second\": %.1f}",
+                   first ? "" : ",", benchmark.name.c_str(), benchmark.name.c_str(), state.iterations,
+                   ns_per_iter, ns_per_iter, state.bytes_processed / elapsed, state.items_processed / elapsed);
+        }
+        else {
+            printf("%-48s %14zu %12.1f %14.1f %14.0f\n", benchmark.name.c_str(), state.iterations,
+                   ns_per_iter, state.bytes_processed / elapsed / (1 << 20),
+                   state.items_processed / elapsed);
+        }
+
+        first = false;
+        fflush(stdout);
+    }
+
+    if (json) {
+        printf("\n  ]\n}\n");
+    }
+
+    return 0;
+}
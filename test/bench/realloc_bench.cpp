@@ -0,0 +1,70 @@
+#include "bench.h"
+#include "../../include/stdlib.h"
+#include "../../include/string.h"
+#include <string>
+#include <vector>
+
+/*
+ * Measures append throughput of buffer which is grown by mem_realloc.
+ * Every iteration appends chunk sized pieces until buffer reaches kTotalSize.
+ */
+
+static constexpr size_t kHeapSize = 64 << 20;
+static constexpr size_t kTotalSize = 1 << 20;
+alignas(16) static char heap[kHeapSize];
+
+enum class Growth {
+    /* realloc on every append */
+    Exact,
+    /* capacity grows by factor of 1.5 */
+    Geometric,
+    /* another allocation lands right after buffer on every append */
+    Fragmented,
+};
+
+static void append(bench::State &state, size_t chunk, Growth growth) {
+    mem_init(heap, sizeof(heap));
+    std::vector<char> data(chunk, 'x');
+    std::vector<void *> pins;
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        size_t len = 0;
+        size_t capacity = chunk;
+        char *buf = static_cast<char *>(mem_malloc(capacity));
+
+        while (len + chunk <= kTotalSize) {
+            if (len + chunk > capacity) {
+                capacity = growth == Growth::Geometric ? (len + chunk) * 3 / 2 : len + chunk;
+                buf = static_cast<char *>(mem_realloc(buf, capacity));
+
+                if (growth == Growth::Fragmented) {
+                    pins.push_back(mem_malloc(16));
+                }
+            }
+
+            __MACONDO_TEST_NAMESPACE::memcpy(buf + len, data.data(), chunk);
+            len += chunk;
+        }
+
+        bench::do_not_optimize(buf);
+        mem_free(buf);
+
+        for (void *p: pins) {
+            mem_free(p);
+        }
+
+        pins.clear();
+        state.bytes_processed += len;
+        state.items_processed += len / chunk;
+    }
+}
+
+static const bench::Registrar sReallocBenchmarks[] = {
+    {"realloc_append/exact/16", [](bench::State &state) { append(state, 16, Growth::Exact); }},
+    {"realloc_append/exact/256", [](bench::State &state) { append(state, 256, Growth::Exact); }},
+    {"realloc_append/exact/4096", [](bench::State &state) { append(state, 4096, Growth::Exact); }},
+    {"realloc_append/geometric/16", [](bench::State &state) { append(state, 16, Growth::Geometric); }},
+    {"realloc_append/geometric/256", [](bench::State &state) { append(state, 256, Growth::Geometric); }},
+    {"realloc_append/fragmented/256", [](bench::State &state) { append(state, 256, Growth::Fragmented); }},
+    {"realloc_append/fragmented/4096", [](bench::State &state) { append(state, 4096, Growth::Fragmented); }},
+};
@@ -0,0 +1,97 @@
+#include "bench.h"
+#include "../../include/macondo/stdio.h"
+#include <cstdint>
+#include <vector>
+
+/*
+ * Integer formatting throughput of snprintf. Every iteration formats kCalls
+ * values, items/s is calls per second and MiB/s counts produced characters.
+ *
+ * Values are drawn log-uniformly so short and long numbers are mixed like in
+ * log lines full of counters and addresses. format/ variants run the same
+ * formats through macondo::format_n which parses them at compile time.
+ */
+
+static constexpr size_t kCalls = 1024;
+
+namespace libc = __MACONDO_TEST_NAMESPACE;
+
+/* xorshift, values must be the same on every run */
+static uint64_t next_random(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static const std::vector<unsigned long long> &values() {
+    static const std::vector<unsigned long long> sValues = [] {
+        std::vector<unsigned long long> result;
+        uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+        for (size_t i = 0; i < kCalls; i++) {
+            unsigned bits = 1 + next_random(state) % 64;
+            result.push_back(next_random(state) >> (64 - bits));
+        }
+
+        return result;
+    }();
+    return sValues;
+}
+
+template<typename Format>
+static void run(bench::State &state, Format format) {
+    char buffer[128];
+    size_t bytes = 0;
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        for (unsigned long long value: values()) {
+            bytes += format(buffer, sizeof(buffer), value);
+            bench::do_not_optimize(buffer[0]);
+        }
+
+        bench::clobber_memory();
+    }
+
+    state.bytes_processed = bytes;
+    state.items_processed = values().size() * state.iterations;
+}
+
+static const bench::Registrar sSnprintfBenchmarks[] = {
+    {"snprintf/u32", [](bench::State &state) {
+        run(state, [](char *b, size_t n, unsigned long long v) { return libc::snprintf(b, n, "%u", (unsigned) v); });
+    }},
+    {"snprintf/u64", [](bench::State &state) {
+        run(state, [](char *b, size_t n, unsigned long long v) { return libc::snprintf(b, n, "%llu", v); });
+    }},
+    {"snprintf/i64", [](bench::State &state) {
+        run(state, [](char *b, size_t n, unsigned long long v) { return libc::snprintf(b, n, "%lld", (long long) v); });
+    }},
+    {"snprintf/x64", [](bench::State &state) {
+        run(state, [](char *b, size_t n, unsigned long long v) { return libc::snprintf(b, n, "%llx", v); });
+    }},
+    {"snprintf/o64", [](bench::State &state) {
+        run(state, [](char *b, size_t n, unsigned long long v) { return libc::snprintf(b, n, "%llo", v); });
+    }},
+    {"snprintf/p", [](bench::State &state) {
+        run(state, [](char *b, size_t n, unsigned long long v) { return libc::snprintf(b, n, "%p", (void *) v); });
+    }},
+    {"snprintf/log_line", [](bench::State &state) {
+        run(state, [](char *b, size_t n, unsigned long long v) {
+            return libc::snprintf(b, n, "[%8u] irq %d at %p count=%llu mask=%#x", (unsigned) v, (int) (v & 0xff),
+                                  (void *) v, v, (unsigned) (v >> 7));
+        });
+    }},
+    {"format/u64", [](bench::State &state) {
+        run(state, [](char *b, size_t n, unsigned long long v) { return macondo::format_n<"%llu">(b, n, v); });
+    }},
+    {"format/x64", [](bench::State &state) {
+        run(state, [](char *b, size_t n, unsigned long long v) { return macondo::format_n<"%llx">(b, n, v); });
+    }},
+    {"format/log_line", [](bench::State &state) {
+        run(state, [](char *b, size_t n, unsigned long long v) {
+            return macondo::format_n<"[%8u] irq %d at %p count=%llu mask=%#x">(b, n, (unsigned) v, (int) (v & 0xff),
+                                                                             (void *) v, v, (unsigned) (v >> 7));
+        });
+    }},
+};
@@ -0,0 +1,237 @@
+#include "bench.h"
+#include "../../include/string.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Throughput and latency of mem* and str* functions over size distributions.
+ * Every iteration makes kCalls calls with sizes drawn from a distribution, so
+ * items/s is calls per second and MiB/s counts bytes the calls processed.
+ *
+ * Name is <function>/<distribution>/<alignment>/<cache>:
+ *   alignment - "aligned" or "unaligned" (dst + 1, src + 3)
+ *   cache     - "hot" reuses the same buffers, "cold" walks a region much
+ *               bigger than last level cache so every call misses
+ */
+
+static constexpr size_t kCalls = 1024;
+static constexpr size_t kMaxSize = 64 << 10;
+/* pad keeps misaligned and terminated strings inside buffer */
+static constexpr size_t kPad = 64;
+static constexpr size_t kSlot = kMaxSize + kPad;
+static constexpr size_t kColdSize = 128 << 20;
+
+namespace libc = __MACONDO_TEST_NAMESPACE;
+
+alignas(64) static char sHotSrc[kSlot];
+alignas(64) static char sHotDst[kSlot];
+alignas(64) static char sCold[kColdSize];
+
+struct Range {
+    size_t min;
+    size_t max;
+    unsigned weight;
+};
+
+struct Distribution {
+    const char *name;
+    std::vector<Range> ranges;
+};
+
+/*
+ * Shapes loosely follow size distributions of llvm-libc memory benchmarks:
+ * most calls are short and long calls are rare but carry most of the bytes.
+ */
+static const Distribution sDistributions[] = {
+    {"tiny", {{0, 16, 1}}},
+    {"small", {{0, 8, 40}, {9, 32, 35}, {33, 128, 20}, {129, 1024, 5}}},
+    {"medium", {{64, 256, 50}, {257, 1024, 35}, {1025, 4096, 15}}},
+    {"large", {{4096, 16384, 60}, {16385, kMaxSize, 40}}},
+};
+
+/* xorshift, sizes must be the same on every run */
+static uint64_t next_random(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static std::vector<size_t> make_sizes(const Distribution &distribution) {
+    std::vector<size_t> sizes;
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    unsigned total = 0;
+
+    for (const Range &range: distribution.ranges) {
+        total += range.weight;
+    }
+
+    for (size_t i = 0; i < kCalls; i++) {
+        unsigned pick = static_cast<unsigned>(next_random(state) % total);
+        const Range *range = &distribution.ranges[0];
+
+        for (const Range &r: distribution.ranges) {
+            range = &r;
+
+            if (pick < r.weight) {
+                break;
+            }
+
+            pick -= r.weight;
+        }
+
+        sizes.push_back(range->min + next_random(state) % (range->max - range->min + 1));
+    }
+
+    return sizes;
+}
+
+/* src and dst buffers of the call, cold buffers move forward on every call */
+class Buffers {
+public:
+    Buffers(bool cold, bool unaligned)
+        : cold_(cold), dst_offset_(unaligned ? 1 : 0), src_offset_(unaligned ? 3 : 0) {
+        /* string functions need non zero bytes up to terminator */
+        static const bool filled = [] {
+            libc::memset(sHotSrc, 'a', sizeof(sHotSrc));
+            libc::memset(sHotDst, 'a', sizeof(sHotDst));
+            libc::memset(sCold, 'a', sizeof(sCold));
+            return true;
+        }();
+        (void) filled;
+    }
+
+    void next() {
+        if (cold_) {
+            position_ += 2 * kSlot;
+
+            if (position_ + 2 * kSlot > kColdSize) {
+                position_ = 0;
+            }
+        }
+    }
+
+    char *dst() const {
+        return (cold_ ? sCold + position_ : sHotDst) + dst_offset_;
+    }
+
+    char *src() const {
+        return (cold_ ? sCold + position_ + kSlot : sHotSrc) + src_offset_;
+    }
+
+private:
+    bool cold_;
+    size_t dst_offset_;
+    size_t src_offset_;
+    size_t position_ = 0;
+};
+
+template<typename Call>
+static void run(bench::State &state, const std::vector<size_t> &sizes, bool cold, bool unaligned, Call call) {
+    Buffers buffers(cold, unaligned);
+    size_t bytes = 0;
+
+    for (size_t size: sizes) {
+        bytes += size;
+    }
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        for (size_t size: sizes) {
+            bench::do_not_optimize(call(buffers.dst(), buffers.src(), size));
+            buffers.next();
+        }
+
+        bench::clobber_memory();
+    }
+
+    state.bytes_processed = bytes * state.iterations;
+    state.items_processed = sizes.size() * state.iterations;
+}
+
+/* string calls terminate both buffers at size and restore them afterwards */
+template<typename Call>
+static auto terminated(Call call) {
+    return [call](char *dst, char *src, size_t size) {
+        dst[size] = '\0';
+        src[size] = '\0';
+        auto ret = call(dst, src, size);
+        dst[size] = 'a';
+        src[size] = 'a';
+        return ret;
+    };
+}
+
+static void register_function(const std::string &function, bool cold, bool unaligned,
+                              const Distribution &distribution, const std::vector<size_t> &sizes) {
+    std::string name = function + "/" + distribution.name + (unaligned ? "/unaligned" : "/aligned")
+        + (cold ? "/cold" : "/hot");
+    bench::Function fn;
+
+    if (function == "memcpy") {
+        fn = [=](bench::State &state) {
+            run(state, sizes, cold, unaligned, [](char *d, char *s, size_t n) { return libc::memcpy(d, s, n); });
+        };
+    }
+    else if (function == "memmove") {
+        /* overlapping move inside one buffer */
+        fn = [=](bench::State &state) {
+            run(state, sizes, cold, unaligned, [](char *d, char *, size_t n) { return libc::memmove(d + 9, d, n); });
+        };
+    }
+    else if (function == "memset") {
+        fn = [=](bench::State &state) {
+            run(state, sizes, cold, unaligned, [](char *d, char *, size_t n) { return libc::memset(d, 'a', n); });
+        };
+    }
+    else if (function == "memcmp") {
+        /* equal buffers, so the whole size is compared */
+        fn = [=](bench::State &state) {
+            run(state, sizes, cold, unaligned, [](char *d, char *s, size_t n) { return libc::memcmp(d, s, n); });
+        };
+    }
+    else if (function == "memchr") {
+        /* needle is absent, the whole size is scanned */
+        fn = [=](bench::State &state) {
+            run(state, sizes, cold, unaligned, [](char *, char *s, size_t n) { return libc::memchr(s, 'z', n); });
+        };
+    }
+    else if (function == "strlen") {
+        fn = [=](bench::State &state) {
+            run(state, sizes, cold, unaligned, terminated([](char *, char *s, size_t) { return libc::strlen(s); }));
+        };
+    }
+    else if (function == "strchr") {
+        /* needle is absent, string is scanned up to terminator */
+        fn = [=](bench::State &state) {
+            run(state, sizes, cold, unaligned, terminated([](char *, char *s, size_t) { return libc::strchr(s, 'z'); }));
+        };
+    }
+    else if (function == "strcmp") {
+        fn = [=](bench::State &state) {
+            run(state, sizes, cold, unaligned, terminated([](char *d, char *s, size_t) { return libc::strcmp(d, s); }));
+        };
+    }
+
+    bench::register_benchmark(name, fn);
+}
+
+static bool register_string_benchmarks() {
+    static const char *const functions[] = {"memcpy", "memmove", "memset", "memcmp", "memchr", "strlen", "strchr", "strcmp"};
+
+    for (const char *function: functions) {
+        for (const Distribution &distribution: sDistributions) {
+            std::vector<size_t> sizes = make_sizes(distribution);
+
+            for (bool unaligned: {false, true}) {
+                for (bool cold: {false, true}) {
+                    register_function(function, cold, unaligned, distribution, sizes);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+static const bool sStringBenchmarks = register_string_benchmarks();
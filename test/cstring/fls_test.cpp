@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "../../include/strings.h"
+
+template<typename T>
+static int expected_fls(T val) {
+    int i = 0;
+
+    for (auto v = static_cast<unsigned long long>(val) & (~0ULL >> (64 - 8 * sizeof(T))); v != 0; v >>= 1) {
+        i++;
+    }
+
+    return i;
+}
+
+TEST(LibcFlsIntTest, Equal) {
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::fls(0), 0);
+
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(__MACONDO_TEST_NAMESPACE::fls(i), expected_fls(i));
+    }
+
+    for (int i = 0; i < 32; i++) {
+        EXPECT_EQ(__MACONDO_TEST_NAMESPACE::fls(static_cast<int>(1U << i)), i + 1);
+    }
+
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::fls(-1), 32);
+}
+
+TEST(LibcFlsLongIntTest, Equal) {
+    for (long int i = 0; i < 1000; i++) {
+        EXPECT_EQ(__MACONDO_TEST_NAMESPACE::flsl(i), expected_fls(i));
+    }
+
+    for (int i = 0; i < 64; i++) {
+        EXPECT_EQ(__MACONDO_TEST_NAMESPACE::flsl(static_cast<long int>(1UL << i)), i + 1);
+    }
+}
+
+TEST(LibcFlsLongLongIntTest, Equal) {
+    for (long long int i = 0; i < 1000; i++) {
+        EXPECT_EQ(__MACONDO_TEST_NAMESPACE::flsll(i), expected_fls(i));
+    }
+
+    for (int i = 0; i < 64; i++) {
+        EXPECT_EQ(__MACONDO_TEST_NAMESPACE::flsll(static_cast<long long int>(1ULL << i)), i + 1);
+    }
+}
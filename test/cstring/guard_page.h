@@ -0,0 +1,66 @@
+#ifndef MACONDOOS_TEST_CSTRING_GUARD_PAGE_H_
+#define MACONDOOS_TEST_CSTRING_GUARD_PAGE_H_
+
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Two mapped pages, one of them is not accessible. Accessible page is filled
+// with 'a', so routines which read a byte past it fault. Test must check
+// valid() before touching memory.
+class GuardPage {
+public:
+    enum Side {
+        kAfter,  // guard page follows accessible one
+        kBefore  // guard page precedes accessible one
+    };
+
+    explicit GuardPage(Side side = kAfter) : page_(sysconf(_SC_PAGESIZE)) {
+        void *region = mmap(nullptr, 2 * page_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (region == MAP_FAILED) {
+            return;
+        }
+
+        region_ = static_cast<char *>(region);
+        begin_ = side == kAfter ? region_ : region_ + page_;
+
+        if (mprotect(side == kAfter ? region_ + page_ : region_, page_, PROT_NONE) != 0) {
+            return;
+        }
+
+        memset(begin_, 'a', page_);
+        valid_ = true;
+    }
+
+    ~GuardPage() {
+        if (region_ != nullptr) {
+            munmap(region_, 2 * page_);
+        }
+    }
+
+    GuardPage(const GuardPage &) = delete;
+    GuardPage &operator=(const GuardPage &) = delete;
+
+    bool valid() const {
+        return valid_;
+    }
+
+    // First accessible byte.
+    char *begin() const {
+        return begin_;
+    }
+
+    // Byte right after accessible page.
+    char *end() const {
+        return begin_ + page_;
+    }
+
+private:
+    size_t page_;
+    char *region_ = nullptr;
+    char *begin_ = nullptr;
+    bool valid_ = false;
+};
+
+#endif //MACONDOOS_TEST_CSTRING_GUARD_PAGE_H_
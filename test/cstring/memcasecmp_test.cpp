@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "../../include/strings.h"
+#include <cstring>
+
+TEST(LibcMemCaseCmpTest, ZeroLengthIsEqual) {
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcasecmp("a", "b", 0), 0);
+}
+
+TEST(LibcMemCaseCmpTest, IgnoresCaseOfLettersOnly) {
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcasecmp("Hello, World", "hELLO, wORLD", 12), 0);
+    // '@' and '`', '[' and '{' differ in the same bit as letters.
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcasecmp("@", "`", 1), '@' - '`');
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcasecmp("[[[[[[[[{", "{{{{{{{{{", 9), '[' - '{');
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcasecmp("ABCDEFGH\xc1", "abcdefgh\xe1", 9), 0xc1 - 0xe1);
+}
+
+TEST(LibcMemCaseCmpTest, DoesNotStopAtNullBytes) {
+    const char lhs[] = {'K', 'e', 'y', '\0', 'A', '\0', 'B', 'c', 'D', 'e'};
+    const char rhs[] = {'k', 'E', 'Y', '\0', 'a', '\0', 'b', 'C', 'd', 'f'};
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcasecmp(lhs, rhs, 9), 0);
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcasecmp(lhs, rhs, 10), 'e' - 'f');
+}
+
+TEST(LibcMemCaseCmpTest, MisalignedBuffersReturnFirstDifference) {
+    char lhs[64];
+    char rhs[64];
+    for (size_t l_offset = 0; l_offset < 8; ++l_offset) {
+        for (size_t r_offset = 0; r_offset < 8; ++r_offset) {
+            for (size_t length = 0; length < 40; ++length) {
+                memset(lhs, 'z', sizeof(lhs));
+                memset(rhs, 'Z', sizeof(rhs));
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcasecmp(lhs + l_offset, rhs + r_offset, length), 0);
+                for (size_t mismatch = 0; mismatch < length; ++mismatch) {
+                    rhs[r_offset + mismatch] = '{';
+                    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcasecmp(lhs + l_offset, rhs + r_offset, length), 'z' - '{');
+                    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcasecmp(rhs + r_offset, lhs + l_offset, length), '{' - 'z');
+                    rhs[r_offset + mismatch] = 'Z';
+                }
+            }
+        }
+    }
+}
@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 #include <stddef.h>
 #include "../../include/string.h"
+#include "guard_page.h"
 
 // A helper function that calls memchr and abstracts away the explicit cast for
 // readability purposes.
@@ -119,4 +120,35 @@ TEST(LlvmLibcMemChrTest, SignedCharacterFound) {
   const char *actual = call_memchr(src, c, size);
   // Should find the first character 'c'.
   ASSERT_EQ(actual[0], c);
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcMemChrTest, EveryAlignmentPositionAndSize) {
+  alignas(16) unsigned char buffer[96];
+  for (size_t align = 0; align < 16; ++align) {
+    for (size_t size = 0; size < 48; ++size) {
+      for (size_t pos = 0; pos < 48; ++pos) {
+        memset(buffer, 'a', sizeof(buffer));
+        // Needle right before the range must not be found.
+        if (align > 0)
+          buffer[align - 1] = 0x80;
+        buffer[align + pos] = 0x80;
+        const char *expected = pos < size ? reinterpret_cast<const char *>(buffer + align + pos) : nullptr;
+        ASSERT_EQ(call_memchr(buffer + align, 0x80, size), expected);
+      }
+    }
+  }
+}
+
+TEST(LlvmLibcMemChrTest, DoesNotReadPastPage) {
+  GuardPage guard;
+  ASSERT_TRUE(guard.valid());
+  char *end = guard.end();
+  for (size_t size = 0; size < 32; ++size) {
+    ASSERT_EQ(call_memchr(end - size, 'z', size), nullptr);
+    if (size > 0) {
+      end[-1] = 'z';
+      ASSERT_EQ(call_memchr(end - size, 'z', size), end - 1);
+      end[-1] = 'a';
+    }
+  }
+}
@@ -8,6 +8,8 @@
 
 #include <gtest/gtest.h>
 #include "../../include/string.h"
+#include <cstring>
+#include "guard_page.h"
 
 TEST(LlvmLibcMemcmpTest, CmpZeroByte) {
   const char *lhs = "ab";
@@ -55,4 +57,40 @@ TEST(LlvmLibcMemcmpTest, Sweep) {
     ASSERT_LT(__MACONDO_TEST_NAMESPACE::memcmp(lhs, rhs, K_MAX_SIZE), 0);
     rhs[i] = 'a';
   }
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcMemcmpTest, MisalignedBuffersReturnFirstByteDifference) {
+  unsigned char lhs[64];
+  unsigned char rhs[64];
+  for (size_t l_offset = 0; l_offset < 8; ++l_offset) {
+    for (size_t r_offset = 0; r_offset < 8; ++r_offset) {
+      for (size_t length = 0; length < 40; ++length) {
+        memset(lhs, 'a', sizeof(lhs));
+        memset(rhs, 'a', sizeof(rhs));
+        ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcmp(lhs + l_offset, rhs + r_offset, length), 0);
+        for (size_t mismatch = 0; mismatch < length; ++mismatch) {
+          // Later difference must not change the result.
+          rhs[r_offset + mismatch] = 0xc0;
+          if (mismatch + 1 < length)
+            lhs[l_offset + length - 1] = 0xff;
+          ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcmp(lhs + l_offset, rhs + r_offset, length), 'a' - 0xc0);
+          ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcmp(rhs + r_offset, lhs + l_offset, length), 0xc0 - 'a');
+          rhs[r_offset + mismatch] = 'a';
+          lhs[l_offset + length - 1] = 'a';
+        }
+      }
+    }
+  }
+}
+
+TEST(LlvmLibcMemcmpTest, DoesNotReadPastPage) {
+  GuardPage guard;
+  ASSERT_TRUE(guard.valid());
+  char *end = guard.end();
+  char other[40];
+  memset(other, 'a', sizeof(other));
+  for (size_t length = 0; length < 32; ++length) {
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcmp(end - length, other + 1, length), 0);
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcmp(other + 3, end - length, length), 0);
+  }
+}
@@ -51,3 +51,25 @@ TEST(LlvmLibcMemcpyTest, Thorough) {
 // FIXME: Add tests with reads and writes on the boundary of a read/write
 // protected page to check we're not reading nor writing prior/past the allowed
 // regions.
+
+TEST(LlvmLibcMemcpyTest, MisalignedSource) {
+    const Data groundtruth = memcpy_get_data(k_numbers);
+    const Data dirty = memcpy_get_data(k_deadcode);
+    // Sizes around every small size branch and the block loop boundaries.
+    for (size_t count : {1, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 1000}) {
+        for (size_t src_align = 0; src_align < 16; ++src_align) {
+            for (size_t dst_align = 0; dst_align < 16; ++dst_align) {
+                auto buffer = dirty;
+                const char *const src = groundtruth.data() + src_align;
+                void *const ret = __MACONDO_TEST_NAMESPACE::memcpy(&buffer[dst_align], src, count);
+                ASSERT_EQ(ret, &buffer[dst_align]);
+                for (size_t i = 0; i < dst_align; ++i)
+                    ASSERT_EQ(buffer[i], dirty[i]);
+                for (size_t i = 0; i < count; ++i)
+                    ASSERT_EQ(buffer[dst_align + i], src[i]);
+                for (size_t i = dst_align + count; i < dirty.size(); ++i)
+                    ASSERT_EQ(buffer[i], dirty[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "../../include/string.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+const char *call_memmem(const void *haystack, size_t haystack_len, const void *needle, size_t needle_len) {
+    return static_cast<const char *>(__MACONDO_TEST_NAMESPACE::memmem(haystack, haystack_len, needle, needle_len));
+}
+
+} // namespace
+
+TEST(LibcMemMemTest, EmptyNeedleIsFoundAtHaystack) {
+    const char haystack[] = "abc";
+    ASSERT_EQ(call_memmem(haystack, 3, "", 0), haystack);
+    ASSERT_EQ(call_memmem(haystack, 0, "", 0), haystack);
+}
+
+TEST(LibcMemMemTest, NeedleLongerThanHaystack) {
+    ASSERT_EQ(call_memmem("abc", 3, "abcd", 4), nullptr);
+    ASSERT_EQ(call_memmem("abc", 0, "a", 1), nullptr);
+}
+
+TEST(LibcMemMemTest, RespectsHaystackLength) {
+    const char haystack[] = "abcdefgh";
+    ASSERT_EQ(call_memmem(haystack, 8, "gh", 2), haystack + 6);
+    ASSERT_EQ(call_memmem(haystack, 7, "gh", 2), nullptr);
+    ASSERT_EQ(call_memmem(haystack, 7, "g", 1), haystack + 6);
+    ASSERT_EQ(call_memmem(haystack, 6, "g", 1), nullptr);
+}
+
+TEST(LibcMemMemTest, SearchesPastNullBytes) {
+    const char haystack[] = {'a', '\0', 'b', '\0', '\0', 'c', 'd', '\0'};
+    const char needle[] = {'\0', '\0', 'c'};
+    ASSERT_EQ(call_memmem(haystack, sizeof(haystack), needle, sizeof(needle)), haystack + 3);
+    // Needle starting with null bytes must not match before haystack.
+    const char zeros[] = {'\0', '\0', '\0', 'x'};
+    ASSERT_EQ(call_memmem(haystack + 4, 4, zeros, sizeof(zeros)), nullptr);
+}
+
+TEST(LibcMemMemTest, MatchesNaiveSearch) {
+    uint64_t state = 0x2545f4914f6cdd1dULL;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+
+    for (int round = 0; round < 5000; ++round) {
+        std::vector<unsigned char> haystack(next() % 300);
+        std::vector<unsigned char> needle(1 + next() % 40);
+        // Zero and 0xff bytes check signedness and terminator handling.
+        for (unsigned char &c : haystack)
+            c = "\0\xff"[next() % 2];
+        for (unsigned char &c : needle)
+            c = "\0\xff"[next() % 2];
+        auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end());
+        const char *expected = it == haystack.end() ? nullptr
+            : reinterpret_cast<const char *>(haystack.data()) + (it - haystack.begin());
+        ASSERT_EQ(call_memmem(haystack.data(), haystack.size(), needle.data(), needle.size()), expected);
+    }
+}
@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 #include <stddef.h>
 #include "../../include/string.h"
+#include "guard_page.h"
 
 // A helper function that calls memrchr and abstracts away the explicit cast for
 // readability purposes.
@@ -111,4 +112,34 @@ TEST(LlvmLibcMemRChrTest, ZeroLengthShouldReturnNullptr) {
   const unsigned char src[4] = {'a', 'b', 'c', '\0'};
   // This will iterate over exactly zero characters, so should return nullptr.
   ASSERT_STREQ(call_memrchr(src, 'd', 0), nullptr);
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcMemRChrTest, EveryAlignmentPositionAndSize) {
+  alignas(16) unsigned char buffer[96];
+  for (size_t align = 0; align < 16; ++align) {
+    for (size_t size = 0; size < 48; ++size) {
+      for (size_t pos = 0; pos < 48; ++pos) {
+        memset(buffer, 'a', sizeof(buffer));
+        // Needle right after the range must not be found.
+        buffer[align + size] = 0x80;
+        buffer[align + pos] = 0x80;
+        const char *expected = pos < size ? reinterpret_cast<const char *>(buffer + align + pos) : nullptr;
+        ASSERT_EQ(call_memrchr(buffer + align, 0x80, size), expected);
+      }
+    }
+  }
+}
+
+TEST(LlvmLibcMemRChrTest, DoesNotReadBeforePage) {
+  GuardPage guard(GuardPage::kBefore);
+  ASSERT_TRUE(guard.valid());
+  char *begin = guard.begin();
+  for (size_t size = 0; size < 32; ++size) {
+    ASSERT_EQ(call_memrchr(begin, 'z', size), nullptr);
+    if (size > 0) {
+      begin[0] = 'z';
+      ASSERT_EQ(call_memrchr(begin, 'z', size), begin);
+      begin[0] = 'a';
+    }
+  }
+}
@@ -47,6 +47,20 @@ TEST(LlvmLibcMemsetTest, Thorough) {
   }
 }
 
+TEST(LlvmLibcMemsetTest, LargeZeroFill) {
+  // Large zero fills take cache line zeroing path on AArch64.
+  Data buffer(9000);
+  for (size_t count : {2047, 2048, 2049, 4095, 4096, 5000, 8191}) {
+    for (size_t align = 0; align < 64; ++align) {
+      std::fill(buffer.begin(), buffer.end(), '#');
+      void *const dst = &buffer[align];
+      ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memset(dst, 0, count), dst);
+      for (size_t i = 0; i < buffer.size(); ++i)
+        ASSERT_EQ(buffer[i], i >= align && i < align + count ? '\0' : '#');
+    }
+  }
+}
+
 // FIXME: Add tests with reads and writes on the boundary of a read/write
 // protected page to check we're not reading nor writing prior/past the allowed
 // regions.
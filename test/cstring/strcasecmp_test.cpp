@@ -4,6 +4,8 @@
 
 #include <gtest/gtest.h>
 #include "../../include/strings.h"
+#include <cstring>
+#include "guard_page.h"
 
 TEST(LlvmLibcStrCaseCmpTest, EmptyStringsShouldReturnZero) {
     const char *s1 = "";
@@ -88,4 +90,62 @@ TEST(LlvmLibcStrCaseCmpTest, StringArgumentSwapChangesSign) {
     result = __MACONDO_TEST_NAMESPACE::strcasecmp(a, b);
     // 'a' - 'b' = -1.
     ASSERT_EQ(result, -1);
-}
\ No newline at end of file
+}
+
+// Letters at range edges and high bytes which are letters with top bit set.
+static const char kCaseAlphabet[] = "@AZ[`az{\x80\xc1\xe1\xff";
+
+static int fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c + 32 : c;
+}
+
+static int reference_strcasecmp(const char *lhs, const char *rhs) {
+    const unsigned char *l = reinterpret_cast<const unsigned char *>(lhs);
+    const unsigned char *r = reinterpret_cast<const unsigned char *>(rhs);
+    for (; fold(*l) == fold(*r) && *l != '\0'; ++l, ++r)
+        ;
+    return fold(*l) - fold(*r);
+}
+
+TEST(LlvmLibcStrCaseCmpTest, MisalignedStringsMatchReference) {
+    char lhs[64];
+    char rhs[64];
+    unsigned state = 1;
+    for (size_t l_offset = 0; l_offset < 8; ++l_offset) {
+        for (size_t r_offset = 0; r_offset < 8; ++r_offset) {
+            for (size_t length = 0; length < 40; ++length) {
+                memset(lhs, 0, sizeof(lhs));
+                memset(rhs, 0, sizeof(rhs));
+                for (size_t i = 0; i < length; ++i) {
+                    state = state * 1103515245 + 12345;
+                    const char c = kCaseAlphabet[(state >> 16) % (sizeof(kCaseAlphabet) - 1)];
+                    const bool letter = (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+                    lhs[l_offset + i] = c;
+                    // Mostly the same byte with case of letters flipped, rarely a mismatch.
+                    rhs[r_offset + i] = (state >> 8) % 16 == 0 ? 'Q' : letter ? c ^ 0x20 : c;
+                }
+                const char *l = lhs + l_offset;
+                const char *r = rhs + r_offset;
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strcasecmp(l, r), reference_strcasecmp(l, r));
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strcasecmp(r, l), reference_strcasecmp(r, l));
+            }
+        }
+    }
+}
+
+TEST(LlvmLibcStrCaseCmpTest, DoesNotReadPastPageWithTerminator) {
+    GuardPage guard;
+    ASSERT_TRUE(guard.valid());
+    char *end = guard.end();
+    end[-1] = '\0';
+    char other[48];
+    for (size_t length = 0; length < 32; ++length) {
+        const char *last = end - 1 - length;
+        for (size_t offset = 0; offset < 8; ++offset) {
+            memset(other, 'A', sizeof(other));
+            other[offset + length] = '\0';
+            ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strcasecmp(last, other + offset), 0);
+            ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strcasecmp(other + offset, last), 0);
+        }
+    }
+}
@@ -8,6 +8,7 @@
 
 #include <gtest/gtest.h>
 #include "../../include/string.h"
+#include "guard_page.h"
 
 TEST(LlvmLibcStrChrTest, FindsFirstCharacter) {
   const char *src = "abcde";
@@ -79,4 +80,34 @@ TEST(LlvmLibcStrChrTest, EmptyStringShouldOnlyMatchNullTerminator) {
   ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strchr("", 'Z'), nullptr);
   ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strchr("", '3'), nullptr);
   ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strchr("", '*'), nullptr);
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcStrChrTest, EveryAlignmentAndPosition) {
+  alignas(16) char buffer[96];
+  for (size_t align = 0; align < 16; ++align) {
+    for (size_t length = 0; length < 48; ++length) {
+      for (size_t pos = 0; pos < 48; ++pos) {
+        memset(buffer, 'a', sizeof(buffer));
+        // Needle right before the string must not be found.
+        if (align > 0)
+          buffer[align - 1] = 'z';
+        buffer[align + pos] = 'z';
+        buffer[align + length] = '\0';
+        const char *expected = pos < length ? buffer + align + pos : nullptr;
+        ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strchr(buffer + align, 'z'), expected);
+        ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strchr(buffer + align, '\0'), buffer + align + length);
+      }
+    }
+  }
+}
+
+TEST(LlvmLibcStrChrTest, DoesNotReadPastPageWithTerminator) {
+  GuardPage guard;
+  ASSERT_TRUE(guard.valid());
+  char *end = guard.end();
+  end[-1] = '\0';
+  for (size_t length = 0; length < 32; ++length) {
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strchr(end - 1 - length, 'z'), nullptr);
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strchr(end - 1 - length, '\0'), end - 1);
+  }
+}
@@ -8,6 +8,8 @@
 
 #include <gtest/gtest.h>
 #include "../../include/string.h"
+#include <cstring>
+#include "guard_page.h"
 
 TEST(LlvmLibcStrCmpTest, EmptyStringsShouldReturnZero) {
   const char *s1 = "";
@@ -94,4 +96,58 @@ TEST(LlvmLibcStrCmpTest, StringArgumentSwapChangesSign) {
   result = __MACONDO_TEST_NAMESPACE::strcmp(a, b);
   // 'a' - 'b' = -1.
   ASSERT_EQ(result, -1);
-}
\ No newline at end of file
+}
+
+// Compares bytes as unsigned char, like the result of strcmp is defined.
+static int reference_strcmp(const char *lhs, const char *rhs) {
+  const unsigned char *l = reinterpret_cast<const unsigned char *>(lhs);
+  const unsigned char *r = reinterpret_cast<const unsigned char *>(rhs);
+  for (; *l == *r && *l != '\0'; ++l, ++r)
+    ;
+  return *l - *r;
+}
+
+TEST(LlvmLibcStrCmpTest, MisalignedStringsMatchReference) {
+  char lhs[64];
+  char rhs[64];
+  for (size_t l_offset = 0; l_offset < 8; ++l_offset) {
+    for (size_t r_offset = 0; r_offset < 8; ++r_offset) {
+      for (size_t length = 0; length < 40; ++length) {
+        for (size_t mismatch = 0; mismatch <= length; ++mismatch) {
+          memset(lhs, 'a', sizeof(lhs));
+          memset(rhs, 'a', sizeof(rhs));
+          lhs[l_offset + length] = '\0';
+          rhs[r_offset + length] = '\0';
+          // High byte checks that bytes are compared as unsigned.
+          if (mismatch < length)
+            rhs[r_offset + mismatch] = '\xc0';
+          const char *l = lhs + l_offset;
+          const char *r = rhs + r_offset;
+          ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strcmp(l, r), reference_strcmp(l, r));
+          ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strcmp(r, l), reference_strcmp(r, l));
+        }
+      }
+    }
+  }
+}
+
+TEST(LlvmLibcStrCmpTest, DoesNotReadPastPageWithTerminator) {
+  GuardPage guard;
+  ASSERT_TRUE(guard.valid());
+  char *end = guard.end();
+  end[-1] = '\0';
+  char other[48];
+  for (size_t length = 0; length < 32; ++length) {
+    const char *last = end - 1 - length;
+    for (size_t offset = 0; offset < 8; ++offset) {
+      memset(other, 'a', sizeof(other));
+      other[offset + length] = '\0';
+      ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strcmp(last, other + offset), 0);
+      ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strcmp(other + offset, last), 0);
+      other[offset + length] = 'b';
+      other[offset + length + 1] = '\0';
+      ASSERT_LT(__MACONDO_TEST_NAMESPACE::strcmp(last, other + offset), 0);
+      ASSERT_GT(__MACONDO_TEST_NAMESPACE::strcmp(other + offset, last), 0);
+    }
+  }
+}
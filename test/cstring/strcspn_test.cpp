@@ -8,6 +8,9 @@
 
 #include <gtest/gtest.h>
 #include "../../include/string.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
 
 TEST(LlvmLibcStrCSpnTest, ComplementarySpanShouldNotGoPastNullTerminator) {
   const char src[5] = {'a', 'b', '\0', 'c', 'd'};
@@ -46,4 +49,32 @@ TEST(LlvmLibcStrCSpnTest, DuplicatedCharactersNotPartOfComplementarySpan) {
   EXPECT_EQ(__MACONDO_TEST_NAMESPACE::strcspn("aaa", "aa"), size_t{0});
   EXPECT_EQ(__MACONDO_TEST_NAMESPACE::strcspn("aaaa", "aa"), size_t{0});
   EXPECT_EQ(__MACONDO_TEST_NAMESPACE::strcspn("aaaa", "baa"), size_t{0});
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcStrCSpnTest, MatchesNaiveScanForAnySetSize) {
+  // Sets of one and two bytes take the word at a time path, bigger ones the
+  // bitmap, offsets move the string start across words.
+  const char alphabet[] = "ab:/ \x80\xff";
+  uint64_t state = 0x9e3779b97f4a7c15ULL;
+  auto next = [&state]() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  };
+  for (int round = 0; round < 5000; ++round) {
+    std::string str(next() % 48, 'a');
+    std::string set(1 + next() % 5, 'a');
+    for (char &c : str)
+      c = alphabet[next() % (sizeof(alphabet) - 1)];
+    for (char &c : set)
+      c = alphabet[next() % (sizeof(alphabet) - 1)];
+    size_t offset = next() % 16;
+    std::string buffer = std::string(offset, 'x') + str;
+    size_t expected = 0;
+    while (expected < str.size() && std::strchr(set.c_str(), str[expected]) == nullptr)
+      ++expected;
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strcspn(buffer.c_str() + offset, set.c_str()), expected)
+        << str << " / " << set;
+  }
+}
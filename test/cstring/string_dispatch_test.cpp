@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "../../include/string.h"
+#include "../../include/macondo/string_dispatch.h"
+#include <cerrno>
+#include <vector>
+
+namespace {
+
+// Restores variant used by the rest of tests.
+class StringDispatchTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        saved_ = string_dispatch_variant();
+    }
+
+    void TearDown() override {
+        string_dispatch_force(saved_);
+    }
+
+    // Runs every dispatched routine on a couple of sizes and alignments.
+    static void check_routines() {
+        std::vector<char> src(300), dst(300);
+        for (size_t i = 0; i < src.size(); ++i)
+            src[i] = static_cast<char>('a' + i % 26);
+
+        for (size_t size : {0, 1, 7, 16, 33, 100, 255}) {
+            for (size_t align : {0, 3}) {
+                std::fill(dst.begin(), dst.end(), '#');
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcpy(&dst[align], &src[align], size), &dst[align]);
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcmp(&dst[align], &src[align], size), 0);
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memmove(&dst[align + 1], &dst[align], size), &dst[align + 1]);
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memcmp(&dst[align + 1], &src[align], size), 0);
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memset(&dst[align], 'z', size), &dst[align]);
+                dst[align + size] = '\0';
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strlen(&dst[align]), size);
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strchr(&dst[align], 'z'), size > 0 ? &dst[align] : nullptr);
+                ASSERT_EQ(__MACONDO_TEST_NAMESPACE::memchr(&dst[align], '\0', size + 1), &dst[align + size]);
+            }
+        }
+    }
+
+private:
+    enum string_variant saved_;
+};
+
+} // namespace
+
+TEST_F(StringDispatchTest, ScalarIsAlwaysAvailable) {
+    ASSERT_EQ(string_dispatch_force(STRING_VARIANT_SCALAR), 0);
+    ASSERT_EQ(string_dispatch_variant(), STRING_VARIANT_SCALAR);
+    check_routines();
+}
+
+TEST_F(StringDispatchTest, SimdIsAvailableWhenCompiledIn) {
+#ifdef LIBC_SIMD
+    // Host vector unit is enough for generic vectors.
+    ASSERT_EQ(string_dispatch_force(STRING_VARIANT_SIMD), 0);
+    ASSERT_EQ(string_dispatch_variant(), STRING_VARIANT_SIMD);
+    check_routines();
+#else
+    ASSERT_EQ(string_dispatch_force(STRING_VARIANT_SIMD), ENOSYS);
+    ASSERT_EQ(string_dispatch_variant(), STRING_VARIANT_SCALAR);
+#endif
+}
+
+TEST_F(StringDispatchTest, InitPicksTheBestVariant) {
+    string_dispatch_init();
+#ifdef LIBC_SIMD
+    ASSERT_EQ(string_dispatch_variant(), STRING_VARIANT_SIMD);
+#else
+    ASSERT_EQ(string_dispatch_variant(), STRING_VARIANT_SCALAR);
+#endif
+    ASSERT_EQ(string_dispatch_force(STRING_VARIANT_AUTO), 0);
+    ASSERT_NE(string_dispatch_variant(), STRING_VARIANT_AUTO);
+    check_routines();
+}
+
+TEST_F(StringDispatchTest, UnknownVariantIsRejected) {
+    const enum string_variant variant = string_dispatch_variant();
+    ASSERT_EQ(string_dispatch_force(static_cast<enum string_variant>(42)), EINVAL);
+    ASSERT_EQ(string_dispatch_variant(), variant);
+}
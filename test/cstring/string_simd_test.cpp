@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "../../include/macondo/string_simd.h"
+#include "guard_page.h"
+#include <vector>
+
+// Vector routines are built with -DMACONDO_LIBC_SIMD=ON only. On a host they
+// are compiled for host vector unit, so results are cross-checked against
+// plain byte loops here.
+#ifdef LIBC_SIMD
+
+namespace {
+
+std::vector<unsigned char> pattern(size_t size) {
+    std::vector<unsigned char> data(size);
+    for (size_t i = 0; i < size; ++i)
+        data[i] = static_cast<unsigned char>(i * 7 + 1);
+    return data;
+}
+
+int sign(int value) {
+    return (value > 0) - (value < 0);
+}
+
+} // namespace
+
+TEST(LibcStringSimdTest, MemcpyMatchesBytes) {
+    const auto src = pattern(256);
+    for (size_t size = 0; size < 160; ++size) {
+        for (size_t src_align = 0; src_align < 16; ++src_align) {
+            for (size_t dst_align = 0; dst_align < 16; ++dst_align) {
+                std::vector<unsigned char> dst(256, 0xee);
+                ASSERT_EQ(simd_memcpy(&dst[dst_align], &src[src_align], size), &dst[dst_align]);
+                for (size_t i = 0; i < dst.size(); ++i) {
+                    const bool inside = i >= dst_align && i < dst_align + size;
+                    ASSERT_EQ(dst[i], inside ? src[src_align + i - dst_align] : 0xee);
+                }
+            }
+        }
+    }
+}
+
+TEST(LibcStringSimdTest, MemsetMatchesBytes) {
+    for (size_t size = 0; size < 160; ++size) {
+        for (size_t align = 0; align < 16; ++align) {
+            std::vector<unsigned char> dst(256, 0xee);
+            ASSERT_EQ(simd_memset(&dst[align], 0x5a, size), &dst[align]);
+            for (size_t i = 0; i < dst.size(); ++i)
+                ASSERT_EQ(dst[i], i >= align && i < align + size ? 0x5a : 0xee);
+        }
+    }
+}
+
+TEST(LibcStringSimdTest, MemchrMatchesBytes) {
+    std::vector<unsigned char> data(128, 'a');
+    for (size_t align = 0; align < 16; ++align) {
+        for (size_t size = 0; size < 64; ++size) {
+            for (size_t pos = 0; pos < 64; ++pos) {
+                std::fill(data.begin(), data.end(), 'a');
+                // Needle before the range must not be found.
+                if (align > 0)
+                    data[align - 1] = 0xf0;
+                data[align + pos] = 0xf0;
+                const void *expected = pos < size ? &data[align + pos] : nullptr;
+                ASSERT_EQ(simd_memchr(&data[align], 0xf0, size), expected);
+            }
+        }
+    }
+}
+
+TEST(LibcStringSimdTest, MemcmpMatchesBytes) {
+    const auto data = pattern(100);
+    for (size_t size = 0; size < 96; ++size) {
+        for (size_t pos = 0; pos <= size; ++pos) {
+            for (int delta : {-1, 1}) {
+                // Different offsets make loads misaligned to each other.
+                std::vector<unsigned char> first(128), second(128);
+                std::copy(data.begin(), data.end(), first.begin() + 5);
+                std::copy(data.begin(), data.end(), second.begin() + 3);
+                if (pos < size)
+                    second[3 + pos] = static_cast<unsigned char>(second[3 + pos] + delta);
+                const int expected = pos < size ? first[5 + pos] - second[3 + pos] : 0;
+                ASSERT_EQ(sign(simd_memcmp(&first[5], &second[3], size)), sign(expected));
+            }
+        }
+    }
+}
+
+TEST(LibcStringSimdTest, StrlenAndStrchrMatchBytes) {
+    std::vector<char> str(128);
+    for (size_t align = 0; align < 16; ++align) {
+        for (size_t length = 0; length < 64; ++length) {
+            for (size_t pos = 0; pos < 64; ++pos) {
+                std::fill(str.begin(), str.end(), 'a');
+                if (align > 0)
+                    str[align - 1] = 'z';
+                str[align + pos] = 'z';
+                str[align + length] = '\0';
+                ASSERT_EQ(simd_strlen(&str[align]), length);
+                const char *expected = pos < length ? &str[align + pos] : nullptr;
+                ASSERT_EQ(simd_strchr(&str[align], 'z'), expected);
+                ASSERT_EQ(simd_strchr(&str[align], '\0'), &str[align + length]);
+            }
+        }
+    }
+}
+
+TEST(LibcStringSimdTest, DoesNotReadPastPage) {
+    GuardPage guard;
+    ASSERT_TRUE(guard.valid());
+    guard.end()[-1] = '\0';
+    for (size_t length = 0; length < 48; ++length) {
+        const char *str = guard.end() - 1 - length;
+        ASSERT_EQ(simd_strlen(str), length);
+        ASSERT_EQ(simd_strchr(str, 'z'), nullptr);
+        ASSERT_EQ(simd_memchr(guard.end() - length, 'z', length), nullptr);
+        ASSERT_EQ(simd_memcmp(guard.end() - length, guard.end() - length, length), 0);
+    }
+}
+
+#endif // LIBC_SIMD
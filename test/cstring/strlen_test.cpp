@@ -8,6 +8,7 @@
 
 #include <gtest/gtest.h>
 #include "../../include/string.h"
+#include "guard_page.h"
 
 TEST(LlvmLibcStrLenTest, EmptyString) {
   const char *empty = "";
@@ -21,4 +22,24 @@ TEST(LlvmLibcStrLenTest, AnyString) {
 
   size_t result = __MACONDO_TEST_NAMESPACE::strlen(any);
   ASSERT_EQ((size_t)12, result);
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcStrLenTest, EveryAlignmentAndLength) {
+  alignas(16) char buffer[96];
+  for (size_t align = 0; align < 16; ++align) {
+    for (size_t length = 0; length < 64; ++length) {
+      memset(buffer, 'a', sizeof(buffer));
+      buffer[align + length] = '\0';
+      ASSERT_EQ(length, __MACONDO_TEST_NAMESPACE::strlen(buffer + align));
+    }
+  }
+}
+
+TEST(LlvmLibcStrLenTest, DoesNotReadPastPageWithTerminator) {
+  GuardPage guard;
+  ASSERT_TRUE(guard.valid());
+  char *end = guard.end();
+  end[-1] = '\0';
+  for (size_t length = 0; length < 32; ++length)
+    ASSERT_EQ(length, __MACONDO_TEST_NAMESPACE::strlen(end - 1 - length));
+}
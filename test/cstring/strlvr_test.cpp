@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "../../include/string.h"
+#include <cstring>
 
 TEST(LibcStrLvrTest, EmptyString) {
     char empty[] = {""};
@@ -18,4 +19,26 @@ TEST(LibcStrLvrTest, TextString) {
     ASSERT_NE(result, static_cast<char *>(nullptr));
     ASSERT_EQ(array, const_cast<const char *>(result));
     ASSERT_STREQ(result, out_array);
-}
\ No newline at end of file
+}
+
+TEST(LibcStrLvrTest, MisalignedStringsAndRangeEdges) {
+    // Bytes around letter ranges and letters with top bit set stay as they are.
+    const char alphabet[] = "@AMZ[`amz{\xc1\xe1";
+    char buffer[64];
+    char expected[64];
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t length = 0; length < 40; ++length) {
+            memset(buffer, 'x', sizeof(buffer));
+            for (size_t i = 0; i < length; ++i) {
+                const unsigned char c = alphabet[(i * 7 + offset) % (sizeof(alphabet) - 1)];
+                buffer[offset + i] = c;
+                expected[i] = static_cast<char>(c >= 'A' && c <= 'Z' ? c + 32 : c);
+            }
+            buffer[offset + length] = '\0';
+            expected[length] = '\0';
+            ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strlwr(buffer + offset), expected);
+            // Bytes after terminator are untouched.
+            ASSERT_EQ(buffer[offset + length + 1], 'x');
+        }
+    }
+}
@@ -4,6 +4,9 @@
 
 #include <gtest/gtest.h>
 #include "../../include/strings.h"
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
 
 // This group is just copies of the strcmp tests, since all the same cases still
 // need to be tested.
@@ -83,4 +86,44 @@ TEST(LlvmLibcStrnCaseCmpTest,
     result = __MACONDO_TEST_NAMESPACE::strncasecmp(s2, s1, 4);
     // 'd' - '\0' = 100.
     ASSERT_EQ(result, 100);
-}
\ No newline at end of file
+}
+
+static int fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c + 32 : c;
+}
+
+static int reference_strncasecmp(const char *lhs, const char *rhs, size_t n) {
+    const unsigned char *l = reinterpret_cast<const unsigned char *>(lhs);
+    const unsigned char *r = reinterpret_cast<const unsigned char *>(rhs);
+    for (; n > 0; --n, ++l, ++r) {
+        if (fold(*l) != fold(*r) || *l == '\0')
+            return fold(*l) - fold(*r);
+    }
+    return 0;
+}
+
+TEST(LlvmLibcStrnCaseCmpTest, MisalignedStringsMatchReference) {
+    char lhs[64];
+    char rhs[64];
+    for (size_t l_offset = 0; l_offset < 8; ++l_offset) {
+        for (size_t r_offset = 0; r_offset < 8; ++r_offset) {
+            for (size_t length = 0; length < 24; ++length) {
+                for (size_t mismatch = 0; mismatch <= length; ++mismatch) {
+                    memset(lhs, 'x', sizeof(lhs));
+                    memset(rhs, 'X', sizeof(rhs));
+                    lhs[l_offset + length] = '\0';
+                    rhs[r_offset + length] = '\0';
+                    // '[' follows 'Z' and '{' follows 'z', neither is folded.
+                    if (mismatch < length)
+                        rhs[r_offset + mismatch] = mismatch % 2 ? '[' : '\xd8';
+                    const char *l = lhs + l_offset;
+                    const char *r = rhs + r_offset;
+                    for (size_t n = 0; n <= length + 9; ++n) {
+                        ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strncasecmp(l, r, n), reference_strncasecmp(l, r, n));
+                        ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strncasecmp(r, l, n), reference_strncasecmp(r, l, n));
+                    }
+                }
+            }
+        }
+    }
+}
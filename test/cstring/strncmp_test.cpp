@@ -8,6 +8,8 @@
 
 #include <gtest/gtest.h>
 #include "../../include/string.h"
+#include <cstring>
+#include "guard_page.h"
 
 // This group is just copies of the strcmp tests, since all the same cases still
 // need to be tested.
@@ -155,4 +157,64 @@ TEST(LlvmLibcStrNCmpTest, StringComparisonEndsOnNullByteEvenWithLongerLength) {
   // Verify operands reversed.
   result = __MACONDO_TEST_NAMESPACE::strncmp(s2, s1, 7);
   ASSERT_EQ(result, 0);
-}
\ No newline at end of file
+}
+
+// Compares bytes as unsigned char, like the result of strncmp is defined.
+static int reference_strncmp(const char *lhs, const char *rhs, size_t n) {
+  const unsigned char *l = reinterpret_cast<const unsigned char *>(lhs);
+  const unsigned char *r = reinterpret_cast<const unsigned char *>(rhs);
+  for (; n > 0; --n, ++l, ++r) {
+    if (*l != *r || *l == '\0')
+      return *l - *r;
+  }
+  return 0;
+}
+
+TEST(LlvmLibcStrNCmpTest, MisalignedStringsMatchReference) {
+  char lhs[64];
+  char rhs[64];
+  for (size_t l_offset = 0; l_offset < 8; ++l_offset) {
+    for (size_t r_offset = 0; r_offset < 8; ++r_offset) {
+      for (size_t length = 0; length < 24; ++length) {
+        for (size_t mismatch = 0; mismatch <= length; ++mismatch) {
+          memset(lhs, 'a', sizeof(lhs));
+          memset(rhs, 'a', sizeof(rhs));
+          lhs[l_offset + length] = '\0';
+          rhs[r_offset + length] = '\0';
+          if (mismatch < length)
+            rhs[r_offset + mismatch] = '\xc0';
+          const char *l = lhs + l_offset;
+          const char *r = rhs + r_offset;
+          // Limits below, at and above the mismatch and the terminator.
+          for (size_t n = 0; n <= length + 9; ++n) {
+            ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strncmp(l, r, n), reference_strncmp(l, r, n));
+            ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strncmp(r, l, n), reference_strncmp(r, l, n));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(LlvmLibcStrNCmpTest, DoesNotReadPastPageWithTerminator) {
+  GuardPage guard;
+  ASSERT_TRUE(guard.valid());
+  char *end = guard.end();
+  end[-1] = '\0';
+  char other[48];
+  for (size_t length = 0; length < 32; ++length) {
+    const char *last = end - 1 - length;
+    for (size_t offset = 0; offset < 8; ++offset) {
+      memset(other, 'a', sizeof(other));
+      other[offset + length] = '\0';
+      ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strncmp(last, other + offset, 1024), 0);
+      ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strncmp(other + offset, last, 1024), 0);
+    }
+  }
+  // Limit ending exactly at the guard page, without terminator.
+  end[-1] = 'a';
+  for (size_t length = 1; length < 32; ++length) {
+    memset(other, 'a', sizeof(other));
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strncmp(end - length, other, length), 0);
+  }
+}
@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 #include <stddef.h>
 #include "../../include/string.h"
+#include "guard_page.h"
 
 TEST(LlvmLibcStrNLenTest, EmptyString) {
   const char *empty = "";
@@ -44,3 +45,12 @@ TEST(LlvmLibcStrNLenTest, CharactersAfterNullTerminatorShouldNotBeIncluded) {
   ASSERT_EQ(static_cast<size_t>(3), __MACONDO_TEST_NAMESPACE::strnlen(str, 4));
   ASSERT_EQ(static_cast<size_t>(3), __MACONDO_TEST_NAMESPACE::strnlen(str, 5));
 }
+
+TEST(LlvmLibcStrNLenTest, DoesNotReadPastPage) {
+  GuardPage guard;
+  ASSERT_TRUE(guard.valid());
+  char *end = guard.end();
+  // Unterminated string up to the end of page limited by max_len.
+  for (size_t length = 0; length < 32; ++length)
+    ASSERT_EQ(length, __MACONDO_TEST_NAMESPACE::strnlen(end - length, length));
+}
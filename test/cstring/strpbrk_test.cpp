@@ -58,4 +58,11 @@ TEST(LlvmLibcStrPBrkTest, FindsFirstOfRepeated) {
 
 TEST(LlvmLibcStrPBrkTest, FindsFirstInBreakset) {
   EXPECT_STREQ(__MACONDO_TEST_NAMESPACE::strpbrk("12345", "34"), "345");
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcStrPBrkTest, HighBytesInBreakset) {
+  EXPECT_STREQ(__MACONDO_TEST_NAMESPACE::strpbrk("abc\xff", "\xff"), "\xff");
+  EXPECT_STREQ(__MACONDO_TEST_NAMESPACE::strpbrk("abc\x80\xff", "\xff\x80"), "\x80\xff");
+  EXPECT_STREQ(__MACONDO_TEST_NAMESPACE::strpbrk("abcdefgh\x80z", "z\x80\xfe"), "\x80z");
+  EXPECT_STREQ(__MACONDO_TEST_NAMESPACE::strpbrk("abcdefgh", "\x80\xff"), nullptr);
+}
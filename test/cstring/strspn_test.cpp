@@ -8,6 +8,9 @@
 
 #include <gtest/gtest.h>
 #include "../../include/string.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
 
 TEST(LlvmLibcStrSpnTest, EmptyStringShouldReturnZeroLengthSpan) {
   // The search should not include the null terminator.
@@ -81,4 +84,32 @@ TEST(LlvmLibcStrSpnTest, DuplicatedCharactersToBeSearchedForShouldStillMatch) {
   EXPECT_EQ(__MACONDO_TEST_NAMESPACE::strspn("aa", "aa"), size_t{2});
   EXPECT_EQ(__MACONDO_TEST_NAMESPACE::strspn("aaa", "aa"), size_t{3});
   EXPECT_EQ(__MACONDO_TEST_NAMESPACE::strspn("aaaa", "aa"), size_t{4});
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcStrSpnTest, MatchesNaiveScanForAnySetSize) {
+  // Sets of one and two bytes take the word at a time path, bigger ones the
+  // bitmap, offsets move the string start across words.
+  const char alphabet[] = "ab:/ \x80\xff";
+  uint64_t state = 0x9e3779b97f4a7c15ULL;
+  auto next = [&state]() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  };
+  for (int round = 0; round < 5000; ++round) {
+    std::string str(next() % 48, 'a');
+    std::string set(1 + next() % 5, 'a');
+    for (char &c : str)
+      c = alphabet[next() % (sizeof(alphabet) - 1)];
+    for (char &c : set)
+      c = alphabet[next() % (sizeof(alphabet) - 1)];
+    size_t offset = next() % 16;
+    std::string buffer = std::string(offset, 'x') + str;
+    size_t expected = 0;
+    while (expected < str.size() && std::strchr(set.c_str(), str[expected]) != nullptr)
+      ++expected;
+    ASSERT_EQ(__MACONDO_TEST_NAMESPACE::strspn(buffer.c_str() + offset, set.c_str()), expected)
+        << str << " / " << set;
+  }
+}
@@ -8,6 +8,8 @@
 
 #include <gtest/gtest.h>
 #include "../../include/string.h"
+#include <cstdint>
+#include <string>
 
 TEST(LlvmLibcStrStrTest, NeedleNotInHaystack) {
   const char *haystack = "12345";
@@ -111,4 +113,41 @@ TEST(LlvmLibcStrStrTest, MorphedNeedle) {
   ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strstr(haystack, "tome"), nullptr);
   ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strstr(haystack, "tire"), nullptr);
   ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strstr(haystack, "timo"), nullptr);
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcStrStrTest, LongAndPeriodicNeedles) {
+  const char *haystack = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab";
+  ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strstr(haystack, "aaaaaaaaaaaaaaaab"), "aaaaaaaaaaaaaaaab");
+  ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strstr(haystack, "aaaaaaaaaaaaaaaac"), nullptr);
+  ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strstr("abcabcabcabcabd abcabcabcabcabc", "abcabcabcabc"),
+               "abcabcabcabcabd abcabcabcabcabc");
+  ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strstr("key=value; token=0123456789abcdef;", "token=0123456789"),
+               "token=0123456789abcdef;");
+  // Needle runs past the end of haystack.
+  ASSERT_STREQ(__MACONDO_TEST_NAMESPACE::strstr("xxxxxxxxxxxxabcdefghij", "abcdefghijk"), nullptr);
+}
+
+TEST(LlvmLibcStrStrTest, MatchesNaiveSearch) {
+  // Two letter alphabet makes plenty of partial and periodic matches.
+  uint64_t state = 0x9e3779b97f4a7c15ULL;
+  auto next = [&state]() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  };
+  for (int round = 0; round < 5000; ++round) {
+    std::string haystack(next() % 300, 'a');
+    std::string needle(1 + next() % 40, 'a');
+    for (char &c : haystack)
+      c = "ab"[next() % 2];
+    for (char &c : needle)
+      c = "ab"[next() % 2];
+    const size_t expected = haystack.find(needle);
+    const char *result = __MACONDO_TEST_NAMESPACE::strstr(haystack.c_str(), needle.c_str());
+    if (expected == std::string::npos)
+      ASSERT_EQ(result, nullptr) << haystack << " / " << needle;
+    else
+      ASSERT_EQ(result, haystack.c_str() + expected) << haystack << " / " << needle;
+  }
+}
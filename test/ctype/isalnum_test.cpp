@@ -8,6 +8,7 @@
 
 #include "../../include/ctype.h"
 
+#include <cstdio>
 #include <gtest/gtest.h>
 
 TEST(LlvmLibcIsAlNum, DefaultLocale) {
@@ -20,4 +21,10 @@ TEST(LlvmLibcIsAlNum, DefaultLocale) {
     else
       EXPECT_EQ(__MACONDO_TEST_NAMESPACE::isalnum(c), 0);
   }
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcIsAlNum, EofAndNegativeCharsAreNotAlNum) {
+  EXPECT_EQ(__MACONDO_TEST_NAMESPACE::isalnum(EOF), 0);
+  for (int ch = -128; ch < 0; ++ch)
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::isalnum(ch), 0);
+}
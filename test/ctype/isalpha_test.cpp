@@ -8,6 +8,7 @@
 
 #include "../../include/ctype.h"
 
+#include <climits>
 #include <gtest/gtest.h>
 
 TEST(LlvmLibcIsAlpha, DefaultLocale) {
@@ -19,4 +20,10 @@ TEST(LlvmLibcIsAlpha, DefaultLocale) {
     else
       EXPECT_EQ(__MACONDO_TEST_NAMESPACE::isalpha(ch), 0);
   }
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcIsAlpha, OutOfRangeValuesAreNotAlpha) {
+  // Values must not alias to a byte, 0x141 would be 'A' otherwise.
+  for (int ch : {0x141, 0x161, 0x1ff, -0xbf, -0x100, INT_MAX, INT_MIN})
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::isalpha(ch), 0);
+}
@@ -8,6 +8,7 @@
 
 #include "../../include/ctype.h"
 
+#include <climits>
 #include <gtest/gtest.h>
 
 TEST(LlvmLibcIsDigit, DefaultLocale) {
@@ -19,4 +20,10 @@ TEST(LlvmLibcIsDigit, DefaultLocale) {
     else
       EXPECT_EQ(__MACONDO_TEST_NAMESPACE::isdigit(ch), 0);
   }
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcIsDigit, OutOfRangeValuesAreNotDigits) {
+  // Values must not alias to a byte, -208 would be '0' otherwise.
+  for (int ch : {-208, 0x130, 0x239, INT_MAX, INT_MIN})
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::isdigit(ch), 0);
+}
@@ -7,6 +7,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "../../include/ctype.h"
+#include <climits>
+#include <cstdio>
 #include <gtest/gtest.h>
 
 TEST(LlvmLibcToLower, DefaultLocale) {
@@ -17,4 +19,15 @@ TEST(LlvmLibcToLower, DefaultLocale) {
     else
       EXPECT_EQ(__MACONDO_TEST_NAMESPACE::tolower(ch), ch);
   }
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcToLower, EofAndNegativeCharsAreUnchanged) {
+  EXPECT_EQ(__MACONDO_TEST_NAMESPACE::tolower(EOF), EOF);
+  for (int ch = -128; ch < 0; ++ch)
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::tolower(ch), ch);
+}
+
+TEST(LlvmLibcToLower, OutOfRangeValuesAreUnchanged) {
+  for (int ch : {0x141, 0x15a, -0xbf, INT_MAX, INT_MIN})
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::tolower(ch), ch);
+}
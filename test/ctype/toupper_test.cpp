@@ -7,6 +7,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "../../include/ctype.h"
+#include <climits>
+#include <cstdio>
 #include <gtest/gtest.h>
 
 TEST(LlvmLibcToUpper, DefaultLocale) {
@@ -17,4 +19,15 @@ TEST(LlvmLibcToUpper, DefaultLocale) {
     else
       EXPECT_EQ(__MACONDO_TEST_NAMESPACE::toupper(ch), ch);
   }
-}
\ No newline at end of file
+}
+
+TEST(LlvmLibcToUpper, EofAndNegativeCharsAreUnchanged) {
+  EXPECT_EQ(__MACONDO_TEST_NAMESPACE::toupper(EOF), EOF);
+  for (int ch = -128; ch < 0; ++ch)
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::toupper(ch), ch);
+}
+
+TEST(LlvmLibcToUpper, OutOfRangeValuesAreUnchanged) {
+  for (int ch : {0x161, 0x17a, -0x9f, INT_MAX, INT_MIN})
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::toupper(ch), ch);
+}
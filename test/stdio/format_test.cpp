@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "../../include/macondo/stdio.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+/* format string is checked at compile time, output must be the one of snprintf */
+#define EXPECT_FORMAT(fmt, ...) do { \
+        char expected[128]; \
+        char buffer[128]; \
+        int expected_len = __MACONDO_TEST_NAMESPACE::snprintf(expected, sizeof(expected), fmt, ## __VA_ARGS__); \
+        int len = macondo::format<fmt>(buffer, ## __VA_ARGS__); \
+        EXPECT_EQ(len, expected_len) << fmt; \
+        EXPECT_STREQ(buffer, expected) << fmt; \
+    } while (0)
+
+TEST(MacondoLibcFormatTest, Text) {
+    EXPECT_FORMAT("");
+    EXPECT_FORMAT("plain text");
+    EXPECT_FORMAT("100%% sure");
+    EXPECT_FORMAT("%%%%");
+    EXPECT_FORMAT("%%");
+}
+
+TEST(MacondoLibcFormatTest, Integers) {
+    EXPECT_FORMAT("%d %i %u", -42, 42, 42u);
+    EXPECT_FORMAT("[%5d] [%-5d] [%05d] [%+d] [% d]", 42, 42, -42, 42, 42);
+    EXPECT_FORMAT("[%.3d] [%8.3d] [%.0d] [%.d] [%.-3d]", 7, -7, 0, 0, 5);
+    EXPECT_FORMAT("%x %X %#x %#X %o %#o", 0xbeefu, 0xbeefu, 255u, 255u, 8u, 8u);
+    EXPECT_FORMAT("%lld %llu %llx", -1234567890123LL, 18446744073709551615ULL, 0xdeadbeefcafeULL);
+    EXPECT_FORMAT("%ld %lu", -5L, 5UL);
+    EXPECT_FORMAT("%d %d", INT32_MIN, INT32_MAX);
+}
+
+TEST(MacondoLibcFormatTest, SmallIntegersArePromoted) {
+    char buffer[32];
+    short s = -3;
+    unsigned char uc = 200;
+    bool b = true;
+
+    EXPECT_EQ(macondo::format<"%d %u %d">(buffer, s, uc, b), 8);
+    EXPECT_STREQ(buffer, "-3 200 1");
+
+    EXPECT_EQ(macondo::format<"%hhd %hhu %hd">(buffer, 300, 300, 70000), 10);
+    EXPECT_STREQ(buffer, "44 44 4464");
+
+    EXPECT_EQ(macondo::format<"%u %x">(buffer, -1, -1), 19);
+    EXPECT_STREQ(buffer, "4294967295 ffffffff");
+}
+
+TEST(MacondoLibcFormatTest, StringsCharsAndPointers) {
+    const char *null_str = nullptr;
+    char name[] = "macondo";
+
+    EXPECT_FORMAT("[%s] [%10s] [%-10s] [%.3s]", "abc", "abc", "abc", "abcdef");
+    EXPECT_FORMAT("%s", name);
+    EXPECT_FORMAT("%s", null_str);
+    EXPECT_FORMAT("%c%c [%3c] [%-3c]", 'o', 'k', 'x', 'y');
+    EXPECT_FORMAT("%p %p", (void *) 0x1a2b3c4d, (void *) nullptr);
+    EXPECT_FORMAT("%p", (const char *) 0x1000);
+}
+
+TEST(MacondoLibcFormatTest, WideArguments) {
+    void *ptr = reinterpret_cast<void *>(static_cast<uintptr_t>(0x7fffdeadbeefULL));
+    size_t size = 1ULL << 40;
+    ssize_t offset = -(1LL << 40);
+
+    EXPECT_FORMAT("%p", ptr);
+    EXPECT_FORMAT("%zu %zd %zx", size, offset, size);
+    EXPECT_FORMAT("%hhu %hhx %hhd", 200, 200, 200);
+}
+
+TEST(MacondoLibcFormatTest, Truncated) {
+    char buffer[8];
+    memset(buffer, '#', sizeof(buffer));
+
+    EXPECT_EQ(macondo::format_n<"%s=%u">(buffer, 6, "abc", 12345u), 5);
+    EXPECT_STREQ(buffer, "abc=1");
+    EXPECT_EQ(buffer[6], '#');
+
+    EXPECT_EQ(macondo::format_n<"%u">(buffer, 0, 1u), 0);
+    EXPECT_EQ(buffer[0], 'a');
+
+    EXPECT_EQ(macondo::format<"%d%d%d%d">(buffer, 11, 22, 33, 44), 7);
+    EXPECT_STREQ(buffer, "1122334");
+}
@@ -29,6 +29,8 @@
 #include <gtest/gtest.h>
 #include "../../include/macondo/stdio.h"
 #include <cstdio>
+#include <string>
+#include <vector>
 
 static constexpr const char *kNull = "(null)";
 static constexpr const char *kNil = "(nil)";
@@ -928,4 +930,133 @@ TEST(MacondoLibcSnprintfTest, Range) {
             ASSERT_EQ(res, 0);
         }
     }
-}
\ No newline at end of file
+}
+
+TEST(MacondoLibcSnprintfTest, NumberLengthBoundaries) {
+    char expected[64];
+    char buffer[64];
+    std::vector<unsigned long long> values = {0, ~0ULL};
+
+    for (unsigned long long power = 1; power <= 10000000000000000000ULL; power *= 10) {
+        values.insert(values.end(), {power - 1, power, power + 1});
+
+        if (power == 10000000000000000000ULL) {
+            break;
+        }
+    }
+
+    for (int bit = 0; bit < 64; bit++) {
+        values.insert(values.end(), {(1ULL << bit) - 1, 1ULL << bit});
+    }
+
+    for (unsigned long long value: values) {
+        for (const char *fmt: {"%llu", "%llx", "%llX", "%llo", "%#llx", "%#llo", "%25llu", "%-25llx|", "%.22llu"}) {
+            int expected_len = std::snprintf(expected, sizeof(expected), fmt, value);
+            int len = __MACONDO_TEST_NAMESPACE::snprintf(buffer, sizeof(buffer), fmt, value);
+
+            ASSERT_EQ(len, expected_len) << fmt << " " << value;
+            ASSERT_STREQ(buffer, expected) << fmt << " " << value;
+        }
+
+        long long signed_value = static_cast<long long>(value >> 1);
+        for (long long number: {signed_value, -signed_value}) {
+            int expected_len = std::snprintf(expected, sizeof(expected), "%+lld", number);
+            int len = __MACONDO_TEST_NAMESPACE::snprintf(buffer, sizeof(buffer), "%+lld", number);
+
+            ASSERT_EQ(len, expected_len) << number;
+            ASSERT_STREQ(buffer, expected) << number;
+        }
+    }
+}
+
+TEST(MacondoLibcSnprintfTest, TruncatedNumber) {
+    char buffer[8];
+
+    for (size_t size = 1; size <= sizeof(buffer); size++) {
+        int len = __MACONDO_TEST_NAMESPACE::snprintf(buffer, size, "%u", 1234567890u);
+
+        ASSERT_EQ(len, static_cast<int>(size - 1));
+        ASSERT_EQ(0, memcmp(buffer, "1234567890", size - 1));
+        ASSERT_EQ(buffer[size - 1], '\0');
+    }
+}
+
+/* collects sink output, stops after limit characters */
+struct Collector {
+    std::string text;
+    std::vector<size_t> chunks;
+    size_t limit = static_cast<size_t>(-1);
+
+    static int sink(void *ctx, const char *data, size_t len) {
+        Collector *collector = static_cast<Collector *>(ctx);
+        collector->text.append(data, len);
+        collector->chunks.push_back(len);
+        return collector->text.size() >= collector->limit;
+    }
+};
+
+TEST(MacondoLibcCbprintfTest, MatchesSnprintf) {
+    char expected[256];
+
+    for (const char *fmt: {"", "plain text", "%d|%5s|%-4c|%#x|%%|%p", "%d%s%c"}) {
+        Collector collector;
+        int expected_len = __MACONDO_TEST_NAMESPACE::snprintf(expected, sizeof(expected), fmt, 42, "abc", 'z', 255u, nullptr);
+        int len = __MACONDO_TEST_NAMESPACE::cbprintf(&Collector::sink, &collector, fmt, 42, "abc", 'z', 255u, nullptr);
+
+        ASSERT_EQ(len, expected_len) << fmt;
+        ASSERT_EQ(collector.text, expected) << fmt;
+    }
+}
+
+TEST(MacondoLibcCbprintfTest, OutputLongerThanStaging) {
+    std::string literal(1000, 'a');
+    std::string arg(3000, 'b');
+    std::string fmt = "<" + literal + ">%s|%700d|%-300u|";
+    Collector collector;
+
+    int len = __MACONDO_TEST_NAMESPACE::cbprintf(&Collector::sink, &collector, fmt.c_str(), arg.c_str(), -5, 7u);
+    std::string expected = "<" + literal + ">" + arg + "|" + std::string(698, ' ') + "-5|7" + std::string(299, ' ') + "|";
+
+    ASSERT_EQ(len, static_cast<int>(expected.size()));
+    ASSERT_EQ(collector.text, expected);
+    EXPECT_GT(collector.chunks.size(), 1u);
+}
+
+TEST(MacondoLibcCbprintfTest, SinkStopsFormatting) {
+    Collector collector;
+    collector.limit = 1;
+
+    int len = __MACONDO_TEST_NAMESPACE::cbprintf(&Collector::sink, &collector, "%s%500d%s", "first", 1, "second");
+
+    ASSERT_EQ(collector.chunks.size(), 1u);
+    ASSERT_EQ(len, static_cast<int>(collector.text.size()));
+    EXPECT_EQ(collector.text.compare(0, 5, "first"), 0);
+}
+
+TEST(MacondoLibcCbprintfTest, NullSinkOrFormat) {
+    Collector collector;
+
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::cbprintf(nullptr, &collector, "abc"), 0);
+    EXPECT_EQ(__MACONDO_TEST_NAMESPACE::cbprintf(&Collector::sink, &collector, nullptr), 0);
+    EXPECT_TRUE(collector.chunks.empty());
+}
+
+TEST(MacondoLibcSnprintfTest, SprintfIsNotBounded) {
+    std::string arg(5000, 'x');
+    std::vector<char> buffer(6000, '#');
+
+    int len = __MACONDO_TEST_NAMESPACE::sprintf(buffer.data(), "[%s]%d", arg.c_str(), 12);
+
+    ASSERT_EQ(len, 5004);
+    ASSERT_EQ(std::string(buffer.data()), "[" + arg + "]12");
+}
+
+TEST(MacondoLibcSnprintfTest, IncompleteConversionAtEnd) {
+    char buffer[16];
+    memset(buffer, '#', sizeof(buffer));
+
+    int len = __MACONDO_TEST_NAMESPACE::snprintf(buffer, sizeof(buffer), "ab%");
+
+    ASSERT_EQ(len, 2);
+    ASSERT_STREQ(buffer, "ab");
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "../../include/stdlib.h"
+#include <cstring>
+#include <vector>
+
+static constexpr size_t kArenaSize = 256 << 10;
+alignas(16) static char region_a[kArenaSize];
+alignas(16) static char region_b[kArenaSize];
+
+class LibcArenaTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        a = arena_init(region_a, sizeof(region_a));
+        b = arena_init(region_b, sizeof(region_b));
+        ASSERT_NE(a, nullptr);
+        ASSERT_NE(b, nullptr);
+    }
+
+    struct mem_arena *a = nullptr;
+    struct mem_arena *b = nullptr;
+};
+
+TEST_F(LibcArenaTest, InitInvalidArguments) {
+    ASSERT_EQ(arena_init(nullptr, kArenaSize), nullptr);
+    ASSERT_EQ(arena_init(region_a, 64), nullptr);
+}
+
+TEST_F(LibcArenaTest, AllocationsStayInsideArena) {
+    char *p = static_cast<char *>(arena_malloc(a, 100));
+    char *q = static_cast<char *>(arena_malloc(b, 100));
+    ASSERT_NE(p, nullptr);
+    ASSERT_NE(q, nullptr);
+    ASSERT_GE(p, region_a);
+    ASSERT_LT(p + 100, region_a + kArenaSize);
+    ASSERT_GE(q, region_b);
+    ASSERT_LT(q + 100, region_b + kArenaSize);
+
+    arena_free(a, p);
+    arena_free(b, q);
+}
+
+TEST_F(LibcArenaTest, ExhaustionDoesNotAffectOtherArena) {
+    std::vector<void *> blocks;
+
+    for (;;) {
+        void *p = arena_malloc(a, 1024);
+
+        if (p == nullptr) {
+            break;
+        }
+
+        blocks.push_back(p);
+    }
+
+    ASSERT_GT(blocks.size(), 200u);
+    ASSERT_NE(arena_malloc(b, 1024), nullptr);
+
+    struct mem_stats stats;
+    arena_get_stats(a, &stats);
+    ASSERT_EQ(stats.failures, 1u);
+    ASSERT_EQ(stats.allocs, blocks.size());
+    arena_get_stats(b, &stats);
+    ASSERT_EQ(stats.failures, 0u);
+    ASSERT_EQ(stats.allocs, 1u);
+
+    for (void *p: blocks) {
+        arena_free(a, p);
+    }
+
+    arena_get_stats(a, &stats);
+    ASSERT_EQ(stats.bytes_in_use, 0u);
+    ASSERT_EQ(stats.free_blocks, 1u);
+}
+
+TEST_F(LibcArenaTest, ForeignPointerIsRefused) {
+    void *p = arena_malloc(a, 64);
+    ASSERT_NE(p, nullptr);
+
+    arena_free(b, p);
+    ASSERT_EQ(arena_realloc(b, p, 128), nullptr);
+
+    struct mem_stats stats;
+    arena_get_stats(b, &stats);
+    ASSERT_EQ(stats.frees, 0u);
+    arena_get_stats(a, &stats);
+    ASSERT_EQ(stats.frees, 0u);
+    ASSERT_GT(stats.bytes_in_use, 0u);
+
+    arena_free(a, p);
+}
+
+TEST_F(LibcArenaTest, Realloc) {
+    char *p = static_cast<char *>(arena_malloc(a, 32));
+    ASSERT_NE(p, nullptr);
+    memset(p, 'x', 32);
+
+    p = static_cast<char *>(arena_realloc(a, p, 4096));
+    ASSERT_NE(p, nullptr);
+
+    for (int i = 0; i < 32; i++) {
+        ASSERT_EQ(p[i], 'x');
+    }
+
+    ASSERT_EQ(arena_realloc(a, p, kArenaSize), nullptr);
+    arena_free(a, p);
+}
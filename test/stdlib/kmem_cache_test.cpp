@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+#include "../../include/stdlib.h"
+#include "../../include/macondo/kmem_cache.h"
+#include "../../include/macondo/page_alloc.h"
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+static constexpr size_t kHeapSize = 4 << 20;
+alignas(16) static char heap[kHeapSize];
+
+struct Inode {
+    uint32_t number;
+    uint32_t mode;
+    uint64_t size;
+    uint32_t blocks[15];
+    uint32_t magic;
+};
+
+static int sCtorCalls = 0;
+
+static void inode_ctor(void *obj) {
+    static_cast<Inode *>(obj)->magic = 0xdeadbeef;
+    sCtorCalls++;
+}
+
+class LibcKmemCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(mem_init(heap, sizeof(heap)), 0);
+        sCtorCalls = 0;
+    }
+};
+
+TEST_F(LibcKmemCacheTest, InvalidArguments) {
+    ASSERT_EQ(kmem_cache_create("zero", 0, 0, 0, nullptr), nullptr);
+    ASSERT_EQ(kmem_cache_create("align", 16, 3, 0, nullptr), nullptr);
+    ASSERT_EQ(kmem_cache_create("huge", SIZE_MAX, 0, 0, nullptr), nullptr);
+    ASSERT_EQ(kmem_cache_create("huge", SIZE_MAX / 8 + 1, 0, 0, nullptr), nullptr);
+    ASSERT_EQ(kmem_cache_create("huge", 64 << 20, 0, 0, nullptr), nullptr);
+}
+
+TEST_F(LibcKmemCacheTest, AllocFree) {
+    kmem_cache *cache = kmem_cache_create("inode", sizeof(Inode), alignof(Inode), 0, inode_ctor);
+    ASSERT_NE(cache, nullptr);
+
+    kmem_cache_stats stats{};
+    kmem_cache_get_stats(cache, &stats);
+    ASSERT_GE(stats.object_size, sizeof(Inode));
+    ASSERT_GE(stats.objects_per_slab, 8u);
+    const size_t count = stats.objects_per_slab * 3 + 1;
+
+    std::vector<Inode *> objects;
+    std::set<Inode *> unique;
+
+    for (size_t i = 0; i < count; i++) {
+        auto *inode = static_cast<Inode *>(kmem_cache_alloc(cache));
+        ASSERT_NE(inode, nullptr);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(inode) % alignof(Inode), 0u);
+        ASSERT_EQ(inode->magic, 0xdeadbeef);
+        inode->number = static_cast<uint32_t>(i);
+        objects.push_back(inode);
+        unique.insert(inode);
+    }
+
+    ASSERT_EQ(unique.size(), count);
+
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(objects[i]->number, i);
+    }
+
+    kmem_cache_get_stats(cache, &stats);
+    ASSERT_EQ(stats.slabs, 4u);
+    ASSERT_EQ(stats.objects_in_use, count);
+    ASSERT_EQ(stats.objects_free, 4 * stats.objects_per_slab - count);
+    ASSERT_EQ(stats.allocs, count);
+    ASSERT_EQ(sCtorCalls, static_cast<int>(4 * stats.objects_per_slab));
+
+    for (Inode *inode: objects) {
+        kmem_cache_free(cache, inode);
+    }
+
+    kmem_cache_get_stats(cache, &stats);
+    ASSERT_EQ(stats.objects_in_use, 0u);
+    ASSERT_EQ(stats.frees, count);
+    ASSERT_EQ(stats.slabs, 4u);
+
+    /* constructed state is preserved, no new slabs needed */
+    void *obj = kmem_cache_alloc(cache);
+    ASSERT_NE(obj, nullptr);
+    ASSERT_EQ(static_cast<Inode *>(obj)->magic, 0xdeadbeef);
+    kmem_cache_free(cache, obj);
+
+    ASSERT_EQ(kmem_cache_shrink(cache), 4u);
+    kmem_cache_get_stats(cache, &stats);
+    ASSERT_EQ(stats.slabs, 0u);
+    ASSERT_EQ(stats.slab_frees, 4u);
+    ASSERT_EQ(stats.objects_free, 0u);
+
+    kmem_cache_destroy(cache);
+}
+
+TEST_F(LibcKmemCacheTest, SharedBetweenThreads) {
+    kmem_cache *cache = kmem_cache_create("shared_inode", sizeof(Inode), 0, 0, nullptr);
+    ASSERT_NE(cache, nullptr);
+    std::vector<std::thread> threads;
+
+    for (uint32_t id = 0; id < 4; id++) {
+        threads.emplace_back([cache, id] {
+            std::vector<Inode *> objects;
+
+            for (int round = 0; round < 200; round++) {
+                for (int i = 0; i < 64; i++) {
+                    auto *inode = static_cast<Inode *>(kmem_cache_alloc(cache));
+                    ASSERT_NE(inode, nullptr);
+                    inode->number = id;
+                    objects.push_back(inode);
+                }
+
+                for (Inode *inode: objects) {
+                    ASSERT_EQ(inode->number, id);
+                    kmem_cache_free(cache, inode);
+                }
+
+                objects.clear();
+            }
+        });
+    }
+
+    for (auto &t: threads) {
+        t.join();
+    }
+
+    kmem_cache_stats stats{};
+    kmem_cache_get_stats(cache, &stats);
+    ASSERT_EQ(stats.objects_in_use, 0u);
+    ASSERT_EQ(stats.allocs, 4u * 200 * 64);
+    ASSERT_EQ(stats.frees, stats.allocs);
+    ASSERT_EQ(stats.objects_free, stats.slabs * stats.objects_per_slab);
+
+    kmem_cache_destroy(cache);
+}
+
+TEST_F(LibcKmemCacheTest, DoubleFreeIsIgnored) {
+    kmem_cache *cache = kmem_cache_create("dentry", 24, 0, 0, nullptr);
+    ASSERT_NE(cache, nullptr);
+    void *a = kmem_cache_alloc(cache);
+    void *b = kmem_cache_alloc(cache);
+    kmem_cache_free(cache, a);
+    kmem_cache_free(cache, a);
+
+    kmem_cache_stats stats{};
+    kmem_cache_get_stats(cache, &stats);
+    ASSERT_EQ(stats.objects_in_use, 1u);
+    ASSERT_EQ(stats.frees, 1u);
+
+    kmem_cache_free(cache, b);
+    kmem_cache_destroy(cache);
+}
+
+TEST_F(LibcKmemCacheTest, BigObjectsAndAlignment) {
+    kmem_cache *cache = kmem_cache_create("buffer", 1500, 64, 0, nullptr);
+    ASSERT_NE(cache, nullptr);
+
+    kmem_cache_stats stats{};
+    kmem_cache_get_stats(cache, &stats);
+    ASSERT_GE(stats.objects_per_slab, 8u);
+    ASSERT_EQ(stats.object_size % 64, 0u);
+
+    std::vector<void *> objects;
+
+    for (int i = 0; i < 100; i++) {
+        void *p = kmem_cache_alloc(cache);
+        ASSERT_NE(p, nullptr);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0u);
+        memset(p, i, 1500);
+        objects.push_back(p);
+    }
+
+    for (int i = 0; i < 100; i++) {
+        auto *p = static_cast<unsigned char *>(objects[i]);
+        ASSERT_EQ(p[0], i);
+        ASSERT_EQ(p[1499], i);
+        kmem_cache_free(cache, p);
+    }
+
+    kmem_cache_destroy(cache);
+}
+
+TEST_F(LibcKmemCacheTest, SlabsFromPageAllocator) {
+    alignas(4096) static char pages[64 * 4096];
+    ASSERT_EQ(page_alloc_init(pages, sizeof(pages)), 0);
+
+    page_alloc_stats before{};
+    page_alloc_get_stats(&before);
+
+    kmem_cache *cache = kmem_cache_create("page_inode", sizeof(Inode), 0, KMEM_CACHE_PAGES, inode_ctor);
+    ASSERT_NE(cache, nullptr);
+
+    std::vector<void *> objects;
+
+    for (int i = 0; i < 200; i++) {
+        auto *inode = static_cast<Inode *>(kmem_cache_alloc(cache));
+        ASSERT_NE(inode, nullptr);
+        ASSERT_GE(reinterpret_cast<char *>(inode), pages);
+        ASSERT_LT(reinterpret_cast<char *>(inode), pages + sizeof(pages));
+        ASSERT_EQ(inode->magic, 0xdeadbeef);
+        objects.push_back(inode);
+    }
+
+    kmem_cache_stats stats{};
+    kmem_cache_get_stats(cache, &stats);
+    page_alloc_stats after{};
+    page_alloc_get_stats(&after);
+    ASSERT_EQ(before.free_pages - after.free_pages, stats.slabs);
+
+    for (void *obj: objects) {
+        kmem_cache_free(cache, obj);
+    }
+
+    kmem_cache_destroy(cache);
+    page_alloc_get_stats(&after);
+    ASSERT_EQ(after.free_pages, before.free_pages);
+}
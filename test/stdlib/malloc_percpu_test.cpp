@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "../../include/stdlib.h"
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+static constexpr size_t kHeapSize = 8 << 20;
+static constexpr unsigned int kCpuCount = 4;
+alignas(16) static char heap[kHeapSize];
+
+/* every thread simulates one cpu core */
+static thread_local unsigned int sCpuId = 0;
+
+static unsigned int current_cpu_id() {
+    return sCpuId;
+}
+
+static void stress(unsigned int cpu, int iterations) {
+    sCpuId = cpu;
+    std::mt19937 rng(cpu);
+    std::vector<std::pair<unsigned char *, size_t>> live;
+
+    for (int i = 0; i < iterations; i++) {
+        if (live.empty() || rng() % 3 != 0) {
+            size_t size = 1 + rng() % (rng() % 8 == 0 ? 2048 : 256);
+            auto *p = static_cast<unsigned char *>(mem_malloc(size));
+
+            if (p == nullptr) {
+                continue;
+            }
+
+            memset(p, static_cast<int>(cpu + 1), size);
+            live.emplace_back(p, size);
+        } else {
+            size_t idx = rng() % live.size();
+            auto [p, size] = live[idx];
+
+            for (size_t j = 0; j < size; j++) {
+                ASSERT_EQ(p[j], cpu + 1);
+            }
+
+            mem_free(p);
+            live[idx] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for (auto [p, size]: live) {
+        mem_free(p);
+    }
+}
+
+class LibcMallocPerCpuTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(mem_init(heap, sizeof(heap)), 0);
+    }
+};
+
+TEST_F(LibcMallocPerCpuTest, InitInvalidArguments) {
+    ASSERT_NE(mem_percpu_init(0, current_cpu_id), 0);
+    ASSERT_NE(mem_percpu_init(kCpuCount + 1, current_cpu_id), 0);
+    ASSERT_NE(mem_percpu_init(kCpuCount, nullptr), 0);
+}
+
+TEST_F(LibcMallocPerCpuTest, FreedBlockIsReused) {
+    ASSERT_EQ(mem_percpu_init(kCpuCount, current_cpu_id), 0);
+    void *p = mem_malloc(40);
+    ASSERT_NE(p, nullptr);
+    mem_free(p);
+    ASSERT_EQ(mem_malloc(33), p);
+    mem_free(p);
+    mem_percpu_drain();
+}
+
+TEST_F(LibcMallocPerCpuTest, DoubleFreeIsIgnored) {
+    ASSERT_EQ(mem_percpu_init(kCpuCount, current_cpu_id), 0);
+    void *p = mem_malloc(40);
+    ASSERT_NE(p, nullptr);
+    mem_free(p);
+    mem_free(p);
+    ASSERT_EQ(mem_realloc(p, 64), nullptr);
+
+    void *first = mem_malloc(40);
+    void *second = mem_malloc(40);
+    ASSERT_EQ(first, p);
+    ASSERT_NE(second, nullptr);
+    ASSERT_NE(second, first);
+
+    mem_free(first);
+    mem_free(second);
+    mem_percpu_drain();
+    void *whole = mem_malloc(kHeapSize - 128);
+    ASSERT_NE(whole, nullptr);
+    mem_free(whole);
+}
+
+TEST_F(LibcMallocPerCpuTest, GlobalHeapIsThreadSafe) {
+    std::vector<std::thread> threads;
+
+    for (unsigned int cpu = 0; cpu < kCpuCount; cpu++) {
+        threads.emplace_back(stress, cpu, 20000);
+    }
+
+    for (auto &t: threads) {
+        t.join();
+    }
+
+    void *p = mem_malloc(kHeapSize - 128);
+    ASSERT_NE(p, nullptr);
+    mem_free(p);
+}
+
+TEST_F(LibcMallocPerCpuTest, MagazinesAreThreadSafe) {
+    ASSERT_EQ(mem_percpu_init(kCpuCount, current_cpu_id), 0);
+    std::vector<std::thread> threads;
+
+    for (unsigned int cpu = 0; cpu < kCpuCount; cpu++) {
+        threads.emplace_back(stress, cpu, 50000);
+    }
+
+    for (auto &t: threads) {
+        t.join();
+    }
+
+    /* blocks freed by one cpu may be cached by another one */
+    mem_percpu_drain();
+    void *p = mem_malloc(kHeapSize - 128);
+    ASSERT_NE(p, nullptr);
+    mem_free(p);
+}
+
+TEST_F(LibcMallocPerCpuTest, CpuIdOutOfRangeUsesHeap) {
+    ASSERT_EQ(mem_percpu_init(2, current_cpu_id), 0);
+    std::thread([] {
+        sCpuId = kCpuCount + 3;
+        void *p = mem_malloc(40);
+        ASSERT_NE(p, nullptr);
+        memset(p, 0x5a, 40);
+        mem_free(p);
+    }).join();
+
+    mem_percpu_drain();
+    void *p = mem_malloc(kHeapSize - 128);
+    ASSERT_NE(p, nullptr);
+    mem_free(p);
+}
@@ -0,0 +1,440 @@
+#include <gtest/gtest.h>
+#include "../../include/stdlib.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+static constexpr size_t kHeapSize = 1 << 20;
+alignas(16) static char heap[kHeapSize];
+
+class LibcMallocTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(mem_init(heap, sizeof(heap)), 0);
+    }
+};
+
+TEST_F(LibcMallocTest, InitInvalidArguments) {
+    ASSERT_NE(mem_init(nullptr, kHeapSize), 0);
+    ASSERT_NE(mem_init(heap, 0), 0);
+}
+
+TEST_F(LibcMallocTest, AllocationsDoNotOverlap) {
+    std::vector<char *> blocks;
+
+    for (size_t i = 1; i < 512; i++) {
+        char *p = static_cast<char *>(mem_malloc(i));
+        ASSERT_NE(p, nullptr);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % sizeof(void *), 0u);
+        memset(p, static_cast<int>(i & 0xff), i);
+        blocks.push_back(p);
+    }
+
+    for (size_t i = 1; i < 512; i++) {
+        char *p = blocks[i - 1];
+
+        for (size_t j = 0; j < i; j++) {
+            ASSERT_EQ(static_cast<unsigned char>(p[j]), i & 0xff);
+        }
+    }
+
+    for (char *p: blocks) {
+        mem_free(p);
+    }
+}
+
+TEST_F(LibcMallocTest, FreedMemoryIsCoalesced) {
+    std::vector<void *> blocks;
+
+    for (int i = 0; i < 1000; i++) {
+        void *p = mem_malloc(128 + i % 64);
+        ASSERT_NE(p, nullptr);
+        blocks.push_back(p);
+    }
+
+    /* free odd blocks first, then even ones to exercise every merge case */
+    for (size_t i = 1; i < blocks.size(); i += 2) {
+        mem_free(blocks[i]);
+    }
+
+    for (size_t i = 0; i < blocks.size(); i += 2) {
+        mem_free(blocks[i]);
+    }
+
+    /* whole heap should be a single free block again */
+    void *p = mem_malloc(kHeapSize - 128);
+    ASSERT_NE(p, nullptr);
+    mem_free(p);
+}
+
+TEST_F(LibcMallocTest, ExhaustionReturnsNull) {
+    ASSERT_EQ(mem_malloc(kHeapSize), nullptr);
+
+    std::vector<void *> blocks;
+    void *p = nullptr;
+
+    while ((p = mem_malloc(4096)) != nullptr) {
+        blocks.push_back(p);
+    }
+
+    ASSERT_GT(blocks.size(), 200u);
+    mem_free(blocks.back());
+    blocks.pop_back();
+    ASSERT_NE(p = mem_malloc(4096), nullptr);
+    mem_free(p);
+
+    for (void *b: blocks) {
+        mem_free(b);
+    }
+}
+
+TEST_F(LibcMallocTest, ReuseFreedBlock) {
+    void *a = mem_malloc(64);
+    void *b = mem_malloc(64);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    mem_free(a);
+    void *c = mem_malloc(48);
+    ASSERT_EQ(a, c);
+    mem_free(b);
+    mem_free(c);
+}
+
+TEST_F(LibcMallocTest, Realloc) {
+    char *p = static_cast<char *>(mem_malloc(32));
+    ASSERT_NE(p, nullptr);
+
+    for (int i = 0; i < 32; i++) {
+        p[i] = static_cast<char>(i);
+    }
+
+    void *guard = mem_malloc(16);
+    char *q = static_cast<char *>(mem_realloc(p, 4096));
+    ASSERT_NE(q, nullptr);
+
+    for (int i = 0; i < 32; i++) {
+        ASSERT_EQ(q[i], static_cast<char>(i));
+    }
+
+    char *r = static_cast<char *>(mem_realloc(q, 8));
+    ASSERT_EQ(r, q);
+
+    for (int i = 0; i < 8; i++) {
+        ASSERT_EQ(r[i], static_cast<char>(i));
+    }
+
+    ASSERT_EQ(mem_realloc(r, kHeapSize * 2), nullptr);
+    mem_free(r);
+    mem_free(guard);
+}
+
+TEST_F(LibcMallocTest, Calloc) {
+    void *p = mem_malloc(256);
+    memset(p, 0xa5, 256);
+    mem_free(p);
+
+    unsigned char *q = static_cast<unsigned char *>(mem_calloc(1, 256));
+    ASSERT_NE(q, nullptr);
+
+    for (int i = 0; i < 256; i++) {
+        ASSERT_EQ(q[i], 0);
+    }
+
+    mem_free(q);
+}
+
+TEST_F(LibcMallocTest, CallocClearsWholeArray) {
+    void *p = mem_malloc(4096);
+    memset(p, 0xa5, 4096);
+    mem_free(p);
+
+    unsigned char *q = static_cast<unsigned char *>(mem_calloc(64, 16));
+    ASSERT_NE(q, nullptr);
+
+    for (int i = 0; i < 64 * 16; i++) {
+        ASSERT_EQ(q[i], 0);
+    }
+
+    mem_free(q);
+}
+
+TEST_F(LibcMallocTest, CallocOverflow) {
+    ASSERT_EQ(mem_calloc(SIZE_MAX / 2, 4), nullptr);
+    ASSERT_EQ(mem_calloc(4, SIZE_MAX / 2), nullptr);
+
+    void *p = mem_calloc(0, 16);
+    mem_free(p);
+}
+
+TEST_F(LibcMallocTest, CallocOnZeroedHeap) {
+    memset(heap, 0, sizeof(heap));
+    ASSERT_EQ(mem_init_zeroed(heap, sizeof(heap)), 0);
+
+    // Every block is dirtied after use, calloc must still return zeroes.
+    std::vector<std::pair<unsigned char *, size_t>> blocks;
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+    for (int i = 0; i < 20000; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        size_t size = 1 + state % 2000;
+        unsigned op = (state >> 32) % 5;
+
+        if (op == 0 && !blocks.empty()) {
+            size_t victim = (state >> 40) % blocks.size();
+            mem_free(blocks[victim].first);
+            blocks[victim] = blocks.back();
+            blocks.pop_back();
+            continue;
+        }
+
+        unsigned char *p = nullptr;
+
+        if (op == 1 && !blocks.empty()) {
+            size_t victim = (state >> 40) % blocks.size();
+            p = static_cast<unsigned char *>(mem_realloc(blocks[victim].first, size));
+            if (p != nullptr) {
+                blocks[victim] = blocks.back();
+                blocks.pop_back();
+            }
+        }
+        else if (op == 2) {
+            p = static_cast<unsigned char *>(mem_aligned_alloc(64, size));
+        }
+        else {
+            p = static_cast<unsigned char *>(mem_calloc(1, size));
+
+            if (p != nullptr) {
+                for (size_t j = 0; j < size; j++) {
+                    ASSERT_EQ(p[j], 0) << "block of " << size << " bytes, offset " << j;
+                }
+            }
+        }
+
+        if (p == nullptr) {
+            continue;
+        }
+
+        memset(p, 0xff, size);
+        blocks.emplace_back(p, size);
+
+        if (blocks.size() > 200) {
+            mem_free(blocks.front().first);
+            blocks.front() = blocks.back();
+            blocks.pop_back();
+        }
+    }
+
+    for (auto &block: blocks) {
+        mem_free(block.first);
+    }
+}
+
+TEST_F(LibcMallocTest, ReallocGrowsIntoNextBlock) {
+    char *p = static_cast<char *>(mem_malloc(64));
+    void *next = mem_malloc(256);
+    void *guard = mem_malloc(16);
+    memset(p, 'a', 64);
+    mem_free(next);
+
+    char *q = static_cast<char *>(mem_realloc(p, 256));
+    ASSERT_EQ(q, p);
+
+    for (int i = 0; i < 64; i++) {
+        ASSERT_EQ(q[i], 'a');
+    }
+
+    /* growth up to the end of free heap is done in place as well */
+    q = static_cast<char *>(mem_realloc(guard, 64 * 1024));
+    ASSERT_EQ(q, guard);
+
+    mem_free(p);
+    mem_free(q);
+}
+
+TEST_F(LibcMallocTest, ReallocGrowsIntoPrevBlock) {
+    void *prev = mem_malloc(256);
+    char *p = static_cast<char *>(mem_malloc(64));
+    void *guard = mem_malloc(16);
+
+    for (int i = 0; i < 64; i++) {
+        p[i] = static_cast<char>(i);
+    }
+
+    mem_free(prev);
+    char *q = static_cast<char *>(mem_realloc(p, 300));
+    ASSERT_EQ(q, prev);
+
+    for (int i = 0; i < 64; i++) {
+        ASSERT_EQ(q[i], static_cast<char>(i));
+    }
+
+    /* tail left after growth is reused */
+    void *r = mem_malloc(16);
+    ASSERT_GT(r, static_cast<void *>(q));
+    ASSERT_LT(r, guard);
+
+    mem_free(r);
+    mem_free(q);
+    mem_free(guard);
+
+    void *whole = mem_malloc(kHeapSize - 128);
+    ASSERT_NE(whole, nullptr);
+    mem_free(whole);
+}
+
+TEST_F(LibcMallocTest, AlignedAlloc) {
+    std::vector<void *> blocks;
+
+    for (size_t alignment = 1; alignment <= 8192; alignment <<= 1) {
+        for (size_t size: {1, 24, 64, 1000, 4096}) {
+            void *p = mem_aligned_alloc(alignment, size);
+            ASSERT_NE(p, nullptr);
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % alignment, 0u);
+            memset(p, 0x5a, size);
+            blocks.push_back(p);
+        }
+    }
+
+    for (void *p: blocks) {
+        mem_free(p);
+    }
+
+    ASSERT_EQ(mem_aligned_alloc(3, 16), nullptr);
+    ASSERT_EQ(mem_aligned_alloc(0, 16), nullptr);
+
+    void *whole = mem_malloc(kHeapSize - 128);
+    ASSERT_NE(whole, nullptr);
+    mem_free(whole);
+}
+
+TEST_F(LibcMallocTest, AlignedAllocSlackIsReused) {
+    void *page = mem_aligned_alloc(4096, 4096);
+    ASSERT_NE(page, nullptr);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(page) % 4096, 0u);
+
+    /* leading slack is a free block, small allocation lands there */
+    void *small = mem_malloc(64);
+    ASSERT_LT(small, page);
+
+    mem_free(small);
+    mem_free(page);
+}
+
+TEST_F(LibcMallocTest, PosixMemalign) {
+    void *p = nullptr;
+    ASSERT_EQ(mem_posix_memalign(&p, 64, 100), 0);
+    ASSERT_NE(p, nullptr);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0u);
+    mem_free(p);
+
+    ASSERT_EQ(mem_posix_memalign(&p, 4, 100), EINVAL);
+    ASSERT_EQ(mem_posix_memalign(&p, 0, 100), EINVAL);
+    ASSERT_EQ(mem_posix_memalign(&p, 48, 100), EINVAL);
+    ASSERT_EQ(mem_posix_memalign(&p, 64, kHeapSize), ENOMEM);
+}
+
+TEST_F(LibcMallocTest, StatsTrackAllocations) {
+    struct mem_stats stats;
+    mem_get_stats(&stats);
+    ASSERT_EQ(stats.bytes_in_use, 0u);
+    ASSERT_EQ(stats.free_blocks, 1u);
+    ASSERT_EQ(stats.largest_free_block, stats.bytes_free);
+    ASSERT_EQ(stats.heap_size, stats.bytes_free + 2 * sizeof(void *));
+    size_t heap_size = stats.heap_size;
+
+    void *a = mem_malloc(100);
+    void *b = mem_malloc(1000);
+    void *c = mem_malloc(100);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    ASSERT_NE(c, nullptr);
+
+    mem_get_stats(&stats);
+    ASSERT_EQ(stats.allocs, 3u);
+    ASSERT_EQ(stats.frees, 0u);
+    ASSERT_GE(stats.bytes_in_use, 1200u);
+    ASSERT_EQ(stats.bytes_in_use, stats.peak_bytes_in_use);
+    size_t peak = stats.peak_bytes_in_use;
+
+    /* hole between a and c can't be merged with the rest of heap */
+    mem_free(b);
+    mem_get_stats(&stats);
+    ASSERT_EQ(stats.frees, 1u);
+    ASSERT_EQ(stats.free_blocks, 2u);
+    ASSERT_EQ(stats.peak_bytes_in_use, peak);
+    ASSERT_LT(stats.bytes_in_use, peak);
+    ASSERT_EQ(stats.heap_size, heap_size);
+    ASSERT_EQ(stats.free_blocks_by_class[5], 1u);
+    ASSERT_LT(stats.largest_free_block, stats.bytes_free);
+
+    size_t histogram_total = 0;
+
+    for (size_t count: stats.free_blocks_by_class) {
+        histogram_total += count;
+    }
+
+    ASSERT_EQ(histogram_total, stats.free_blocks);
+
+    mem_free(a);
+    mem_free(c);
+    mem_get_stats(&stats);
+    ASSERT_EQ(stats.bytes_in_use, 0u);
+    ASSERT_EQ(stats.free_blocks, 1u);
+    ASSERT_EQ(stats.frees, 3u);
+}
+
+TEST_F(LibcMallocTest, StatsCountFailures) {
+    struct mem_stats stats;
+
+    ASSERT_EQ(mem_malloc(kHeapSize), nullptr);
+    void *p = mem_malloc(64);
+    ASSERT_EQ(mem_realloc(p, kHeapSize), nullptr);
+    p = mem_realloc(p, 128);
+
+    mem_get_stats(&stats);
+    ASSERT_EQ(stats.failures, 2u);
+    ASSERT_EQ(stats.allocs, 1u);
+    ASSERT_EQ(stats.reallocs, 2u);
+
+    mem_free(p);
+}
+
+TEST_F(LibcMallocTest, TraceRecordsCalls) {
+    struct mem_trace_record ring[4];
+    struct mem_trace_record records[4];
+
+    int ret = mem_trace_start(ring, 4, nullptr);
+
+    if (ret == ENOSYS) {
+        GTEST_SKIP() << "libc is built without MACONDO_MALLOC_TRACE";
+    }
+
+    ASSERT_EQ(ret, 0);
+    void *a = mem_malloc(100);
+    void *b = mem_aligned_alloc(64, 32);
+    void *c = mem_realloc(a, 200);
+    mem_free(b);
+    mem_free(c);
+    ASSERT_EQ(mem_trace_stop(), 5u);
+
+    /* the oldest record was overwritten */
+    ASSERT_EQ(mem_trace_read(records, 4), 4u);
+    ASSERT_EQ(records[0].op, MEM_TRACE_ALIGNED_ALLOC);
+    ASSERT_EQ(records[0].alignment, 64u);
+    ASSERT_EQ(records[0].ptr, reinterpret_cast<size_t>(b));
+    ASSERT_EQ(records[1].op, MEM_TRACE_REALLOC);
+    ASSERT_EQ(records[1].size, 200u);
+    ASSERT_EQ(records[1].old_ptr, reinterpret_cast<size_t>(a));
+    ASSERT_EQ(records[1].ptr, reinterpret_cast<size_t>(c));
+    ASSERT_EQ(records[2].op, MEM_TRACE_FREE);
+    ASSERT_EQ(records[3].ptr, reinterpret_cast<size_t>(c));
+    ASSERT_LT(records[2].timestamp, records[3].timestamp);
+
+    /* stopped tracing doesn't log */
+    mem_free(mem_malloc(16));
+    ASSERT_EQ(mem_trace_read(records, 1), 1u);
+    ASSERT_EQ(records[0].op, MEM_TRACE_FREE);
+    ASSERT_EQ(records[0].ptr, reinterpret_cast<size_t>(c));
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "../../include/macondo/page_alloc.h"
+#include <sys/mman.h>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+static constexpr size_t kPageSize = 4096;
+static constexpr size_t kArenaSize = 64 << 20;
+
+class LibcPageAllocTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        arena = static_cast<char *>(mmap(nullptr, kArenaSize, PROT_READ | PROT_WRITE,
+                                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        ASSERT_NE(arena, MAP_FAILED);
+    }
+
+    void TearDown() override {
+        munmap(arena, kArenaSize);
+    }
+
+    char *arena = nullptr;
+};
+
+TEST_F(LibcPageAllocTest, InitInvalidArguments) {
+    ASSERT_NE(page_alloc_init(nullptr, kArenaSize), 0);
+    ASSERT_NE(page_alloc_init(arena, kPageSize - 1), 0);
+    ASSERT_NE(page_alloc_init(arena + 1, kPageSize), 0);
+}
+
+TEST_F(LibcPageAllocTest, Order) {
+    ASSERT_EQ(page_order(0), 0u);
+    ASSERT_EQ(page_order(1), 0u);
+    ASSERT_EQ(page_order(kPageSize), 0u);
+    ASSERT_EQ(page_order(kPageSize + 1), 1u);
+    ASSERT_EQ(page_order(3 * kPageSize), 2u);
+    ASSERT_EQ(page_order(1024 * kPageSize), 10u);
+}
+
+TEST_F(LibcPageAllocTest, BlocksAreAlignedAndDisjoint) {
+    /* unaligned region makes allocator deal with partial blocks on both ends */
+    ASSERT_EQ(page_alloc_init(arena + 3 * kPageSize + 100, kArenaSize - 5 * kPageSize), 0);
+
+    page_alloc_stats stats{};
+    page_alloc_get_stats(&stats);
+    const size_t total = stats.total_pages;
+    ASSERT_EQ(stats.free_pages, total);
+
+    std::mt19937 rng(42);
+    std::vector<std::pair<char *, unsigned int>> blocks;
+    std::set<std::pair<char *, char *>> ranges;
+
+    for (int i = 0; i < 2000; i++) {
+        unsigned int order = rng() % 5;
+        char *p = static_cast<char *>(page_alloc(order));
+
+        if (p == nullptr) {
+            break;
+        }
+
+        size_t size = kPageSize << order;
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % size, 0u);
+        ASSERT_GE(p, arena);
+        ASSERT_LE(p + size, arena + kArenaSize);
+
+        auto it = ranges.lower_bound({p, nullptr});
+        if (it != ranges.end()) {
+            ASSERT_GE(it->first, p + size);
+        }
+        if (it != ranges.begin()) {
+            ASSERT_LE(std::prev(it)->second, p);
+        }
+
+        ranges.insert({p, p + size});
+        memset(p, order, size);
+        blocks.emplace_back(p, order);
+    }
+
+    page_alloc_get_stats(&stats);
+    size_t used = 0;
+
+    for (auto [p, order]: blocks) {
+        used += 1UL << order;
+    }
+
+    ASSERT_EQ(stats.free_pages, total - used);
+    ASSERT_EQ(stats.allocs, blocks.size());
+
+    std::shuffle(blocks.begin(), blocks.end(), rng);
+
+    for (auto [p, order]: blocks) {
+        ASSERT_EQ(static_cast<unsigned char>(p[0]), order);
+        page_free(p, order);
+    }
+
+    page_alloc_get_stats(&stats);
+    ASSERT_EQ(stats.free_pages, total);
+    ASSERT_EQ(stats.frees, blocks.size());
+}
+
+TEST_F(LibcPageAllocTest, BuddiesAreMerged) {
+    ASSERT_EQ(page_alloc_init(arena, kArenaSize), 0);
+
+    page_alloc_stats initial{};
+    page_alloc_get_stats(&initial);
+
+    std::vector<void *> pages;
+    void *p = nullptr;
+
+    while ((p = page_alloc(0)) != nullptr) {
+        pages.push_back(p);
+    }
+
+    ASSERT_EQ(pages.size(), initial.total_pages);
+    ASSERT_EQ(page_alloc(0), nullptr);
+
+    page_alloc_stats stats{};
+    page_alloc_get_stats(&stats);
+    ASSERT_EQ(stats.failures, 2u);
+
+    for (void *page: pages) {
+        page_free(page, 0);
+    }
+
+    page_alloc_get_stats(&stats);
+
+    for (unsigned int order = 0; order < PAGE_ORDER_COUNT; order++) {
+        ASSERT_EQ(stats.free_blocks[order], initial.free_blocks[order]);
+    }
+
+    ASSERT_NE(page_alloc(PAGE_MAX_ORDER), nullptr);
+    ASSERT_EQ(page_alloc(PAGE_MAX_ORDER + 1), nullptr);
+}
+
+TEST_F(LibcPageAllocTest, Fragmentation) {
+    ASSERT_EQ(page_alloc_init(arena, 64 * kPageSize), 0);
+    ASSERT_EQ(page_alloc_fragmentation(0), 0u);
+
+    std::vector<void *> pages;
+    void *p = nullptr;
+
+    while ((p = page_alloc(0)) != nullptr) {
+        pages.push_back(p);
+    }
+
+    /* free every other page, no two free pages are buddies */
+    for (size_t i = 0; i < pages.size(); i += 2) {
+        page_free(pages[i], 0);
+    }
+
+    ASSERT_EQ(page_alloc_fragmentation(0), 0u);
+    ASSERT_EQ(page_alloc_fragmentation(1), 1000u);
+    ASSERT_EQ(page_alloc(1), nullptr);
+}
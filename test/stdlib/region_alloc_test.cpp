@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "../../include/stdlib.h"
+#include "../../include/macondo/region_alloc.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+static constexpr size_t kHeapSize = 1 << 20;
+alignas(16) static char heap[kHeapSize];
+
+class LibcRegionAllocTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(mem_init(heap, sizeof(heap)), 0);
+    }
+
+    static size_t bytes_in_use() {
+        struct mem_stats stats;
+        mem_get_stats(&stats);
+        return stats.bytes_in_use;
+    }
+};
+
+TEST_F(LibcRegionAllocTest, AllocationsAreAlignedAndDistinct) {
+    struct region region;
+    region_init(&region, nullptr, 0, 256);
+    std::vector<char *> blocks;
+
+    for (size_t i = 1; i < 200; i++) {
+        size_t align = 1UL << (i % 7);
+        char *p = static_cast<char *>(region_alloc(&region, i, align));
+        ASSERT_NE(p, nullptr);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % align, 0u);
+        memset(p, static_cast<int>(i), i);
+        blocks.push_back(p);
+    }
+
+    for (size_t i = 1; i < 200; i++) {
+        for (size_t j = 0; j < i; j++) {
+            ASSERT_EQ(static_cast<unsigned char>(blocks[i - 1][j]), i);
+        }
+    }
+
+    region_destroy(&region);
+    ASSERT_EQ(bytes_in_use(), 0u);
+}
+
+TEST_F(LibcRegionAllocTest, BufferIsUsedBeforeHeap) {
+    alignas(16) static char buffer[1024];
+    struct region region;
+    region_init(&region, buffer, sizeof(buffer), 0);
+
+    char *p = static_cast<char *>(region_alloc(&region, 512, 8));
+    ASSERT_GE(p, buffer);
+    ASSERT_LT(p, buffer + sizeof(buffer));
+    ASSERT_EQ(bytes_in_use(), 0u);
+
+    /* buffer is exhausted, next chunk comes from heap */
+    char *q = static_cast<char *>(region_alloc(&region, 1024, 8));
+    ASSERT_NE(q, nullptr);
+    ASSERT_TRUE(q < buffer || q >= buffer + sizeof(buffer));
+    ASSERT_GT(bytes_in_use(), 0u);
+
+    /* heap chunks are released, buffer is kept */
+    region_destroy(&region);
+    ASSERT_EQ(bytes_in_use(), 0u);
+    ASSERT_EQ(region_alloc(&region, 16, 8), buffer + (p - buffer));
+}
+
+TEST_F(LibcRegionAllocTest, ResetReusesChunks) {
+    struct region region;
+    region_init(&region, nullptr, 0, 512);
+    char *first = static_cast<char *>(region_alloc(&region, 64, 8));
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_NE(region_alloc(&region, 100, 8), nullptr);
+    }
+
+    size_t in_use = bytes_in_use();
+    region_reset(&region);
+    ASSERT_EQ(region_alloc(&region, 64, 8), first);
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_NE(region_alloc(&region, 100, 8), nullptr);
+    }
+
+    ASSERT_EQ(bytes_in_use(), in_use);
+    region_destroy(&region);
+}
+
+TEST_F(LibcRegionAllocTest, OversizedAllocation) {
+    struct region region;
+    region_init(&region, nullptr, 0, 64);
+
+    ASSERT_NE(region_alloc(&region, 64 << 10, 4096), nullptr);
+    ASSERT_EQ(region_alloc(&region, kHeapSize, 8), nullptr);
+    ASSERT_EQ(region_alloc(&region, SIZE_MAX - 8, 8), nullptr);
+    ASSERT_NE(region_alloc(&region, 16, 8), nullptr);
+    region_destroy(&region);
+}
+
+TEST_F(LibcRegionAllocTest, CxxAllocator) {
+    struct region region;
+    region_init(&region, nullptr, 0, 0);
+
+    {
+        macondo::region_allocator<int> alloc(&region);
+        std::vector<int, macondo::region_allocator<int>> values(alloc);
+
+        for (int i = 0; i < 1000; i++) {
+            values.push_back(i);
+        }
+
+        for (int i = 0; i < 1000; i++) {
+            ASSERT_EQ(values[i], i);
+        }
+
+        macondo::region_allocator<double> other(alloc);
+        ASSERT_TRUE(other == alloc);
+    }
+
+    region_destroy(&region);
+    ASSERT_EQ(bytes_in_use(), 0u);
+}